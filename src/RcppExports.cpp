@@ -19,9 +19,133 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// abc_geneology_haplotypes
+List abc_geneology_haplotypes(IntegerMatrix observed, int draws, int generations, NumericVector population_size_prior, NumericVector mutation_rates_lower, NumericVector mutation_rates_upper, NumericVector growth_rate_prior, CharacterVector summaries, double tolerance, int seed, int threads, bool progress);
+RcppExport SEXP _malan_abc_geneology_haplotypes(SEXP observedSEXP, SEXP drawsSEXP, SEXP generationsSEXP, SEXP population_size_priorSEXP, SEXP mutation_rates_lowerSEXP, SEXP mutation_rates_upperSEXP, SEXP growth_rate_priorSEXP, SEXP summariesSEXP, SEXP toleranceSEXP, SEXP seedSEXP, SEXP threadsSEXP, SEXP progressSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< IntegerMatrix >::type observed(observedSEXP);
+    Rcpp::traits::input_parameter< int >::type draws(drawsSEXP);
+    Rcpp::traits::input_parameter< int >::type generations(generationsSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type population_size_prior(population_size_priorSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type mutation_rates_lower(mutation_rates_lowerSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type mutation_rates_upper(mutation_rates_upperSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type growth_rate_prior(growth_rate_priorSEXP);
+    Rcpp::traits::input_parameter< CharacterVector >::type summaries(summariesSEXP);
+    Rcpp::traits::input_parameter< double >::type tolerance(toleranceSEXP);
+    Rcpp::traits::input_parameter< int >::type seed(seedSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< bool >::type progress(progressSEXP);
+    rcpp_result_gen = Rcpp::wrap(abc_geneology_haplotypes(observed, draws, generations, population_size_prior, mutation_rates_lower, mutation_rates_upper, growth_rate_prior, summaries, tolerance, seed, threads, progress));
+    return rcpp_result_gen;
+END_RCPP
+}
+// estimate_match_distribution
+Rcpp::List estimate_match_distribution(Rcpp::ListOf< Rcpp::XPtr<Individual> > suspects, Rcpp::XPtr< std::vector<Pedigree*> > pedigrees, Rcpp::NumericVector mutation_rates, int replicates, int generation_upper_bound_in_result, bool only_suspect_pedigrees, int seed, int threads, bool progress);
+RcppExport SEXP _malan_estimate_match_distribution(SEXP suspectsSEXP, SEXP pedigreesSEXP, SEXP mutation_ratesSEXP, SEXP replicatesSEXP, SEXP generation_upper_bound_in_resultSEXP, SEXP only_suspect_pedigreesSEXP, SEXP seedSEXP, SEXP threadsSEXP, SEXP progressSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::ListOf< Rcpp::XPtr<Individual> > >::type suspects(suspectsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::XPtr< std::vector<Pedigree*> > >::type pedigrees(pedigreesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type mutation_rates(mutation_ratesSEXP);
+    Rcpp::traits::input_parameter< int >::type replicates(replicatesSEXP);
+    Rcpp::traits::input_parameter< int >::type generation_upper_bound_in_result(generation_upper_bound_in_resultSEXP);
+    Rcpp::traits::input_parameter< bool >::type only_suspect_pedigrees(only_suspect_pedigreesSEXP);
+    Rcpp::traits::input_parameter< int >::type seed(seedSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< bool >::type progress(progressSEXP);
+    rcpp_result_gen = Rcpp::wrap(estimate_match_distribution(suspects, pedigrees, mutation_rates, replicates, generation_upper_bound_in_result, only_suspect_pedigrees, seed, threads, progress));
+    return rcpp_result_gen;
+END_RCPP
+}
+// run_pipeline
+List run_pipeline(List parameters);
+RcppExport SEXP _malan_run_pipeline(SEXP parametersSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< List >::type parameters(parametersSEXP);
+    rcpp_result_gen = Rcpp::wrap(run_pipeline(parameters));
+    return rcpp_result_gen;
+END_RCPP
+}
+// query_server_run
+void query_server_run(Rcpp::XPtr< std::vector<Pedigree*> > pedigrees, std::string socket_path, int generation_upper_bound_in_result, int threads);
+RcppExport SEXP _malan_query_server_run(SEXP pedigreesSEXP, SEXP socket_pathSEXP, SEXP generation_upper_bound_in_resultSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr< std::vector<Pedigree*> > >::type pedigrees(pedigreesSEXP);
+    Rcpp::traits::input_parameter< std::string >::type socket_path(socket_pathSEXP);
+    Rcpp::traits::input_parameter< int >::type generation_upper_bound_in_result(generation_upper_bound_in_resultSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    query_server_run(pedigrees, socket_path, generation_upper_bound_in_result, threads);
+    return R_NilValue;
+END_RCPP
+}
+// query_server_info
+IntegerVector query_server_info(std::string socket_path);
+RcppExport SEXP _malan_query_server_info(SEXP socket_pathSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type socket_path(socket_pathSEXP);
+    rcpp_result_gen = Rcpp::wrap(query_server_info(socket_path));
+    return rcpp_result_gen;
+END_RCPP
+}
+// query_match_counts
+IntegerVector query_match_counts(std::string socket_path, IntegerMatrix haplotypes);
+RcppExport SEXP _malan_query_match_counts(SEXP socket_pathSEXP, SEXP haplotypesSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type socket_path(socket_pathSEXP);
+    Rcpp::traits::input_parameter< IntegerMatrix >::type haplotypes(haplotypesSEXP);
+    rcpp_result_gen = Rcpp::wrap(query_match_counts(socket_path, haplotypes));
+    return rcpp_result_gen;
+END_RCPP
+}
+// query_relatives
+DataFrame query_relatives(std::string socket_path, IntegerVector pids, IntegerVector max_L1);
+RcppExport SEXP _malan_query_relatives(SEXP socket_pathSEXP, SEXP pidsSEXP, SEXP max_L1SEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type socket_path(socket_pathSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type pids(pidsSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type max_L1(max_L1SEXP);
+    rcpp_result_gen = Rcpp::wrap(query_relatives(socket_path, pids, max_L1));
+    return rcpp_result_gen;
+END_RCPP
+}
+// query_distances
+DataFrame query_distances(std::string socket_path, IntegerVector pids_1, IntegerVector pids_2);
+RcppExport SEXP _malan_query_distances(SEXP socket_pathSEXP, SEXP pids_1SEXP, SEXP pids_2SEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type socket_path(socket_pathSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type pids_1(pids_1SEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type pids_2(pids_2SEXP);
+    rcpp_result_gen = Rcpp::wrap(query_distances(socket_path, pids_1, pids_2));
+    return rcpp_result_gen;
+END_RCPP
+}
+// query_server_shutdown
+void query_server_shutdown(std::string socket_path);
+RcppExport SEXP _malan_query_server_shutdown(SEXP socket_pathSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type socket_path(socket_pathSEXP);
+    query_server_shutdown(socket_path);
+    return R_NilValue;
+END_RCPP
+}
 // sample_geneology
-List sample_geneology(size_t population_size, int generations, int generations_full, int generations_return, bool enable_gamma_variance_extension, double gamma_parameter_shape, double gamma_parameter_scale, bool progress, bool verbose_result);
-RcppExport SEXP _malan_sample_geneology(SEXP population_sizeSEXP, SEXP generationsSEXP, SEXP generations_fullSEXP, SEXP generations_returnSEXP, SEXP enable_gamma_variance_extensionSEXP, SEXP gamma_parameter_shapeSEXP, SEXP gamma_parameter_scaleSEXP, SEXP progressSEXP, SEXP verbose_resultSEXP) {
+List sample_geneology(size_t population_size, int generations, int generations_full, int generations_return, bool enable_gamma_variance_extension, double gamma_parameter_shape, double gamma_parameter_scale, bool progress, bool verbose_result, bool diagnostics);
+RcppExport SEXP _malan_sample_geneology(SEXP population_sizeSEXP, SEXP generationsSEXP, SEXP generations_fullSEXP, SEXP generations_returnSEXP, SEXP enable_gamma_variance_extensionSEXP, SEXP gamma_parameter_shapeSEXP, SEXP gamma_parameter_scaleSEXP, SEXP progressSEXP, SEXP verbose_resultSEXP, SEXP diagnosticsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -34,7 +158,139 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< double >::type gamma_parameter_scale(gamma_parameter_scaleSEXP);
     Rcpp::traits::input_parameter< bool >::type progress(progressSEXP);
     Rcpp::traits::input_parameter< bool >::type verbose_result(verbose_resultSEXP);
-    rcpp_result_gen = Rcpp::wrap(sample_geneology(population_size, generations, generations_full, generations_return, enable_gamma_variance_extension, gamma_parameter_shape, gamma_parameter_scale, progress, verbose_result));
+    Rcpp::traits::input_parameter< bool >::type diagnostics(diagnosticsSEXP);
+    rcpp_result_gen = Rcpp::wrap(sample_geneology(population_size, generations, generations_full, generations_return, enable_gamma_variance_extension, gamma_parameter_shape, gamma_parameter_scale, progress, verbose_result, diagnostics));
+    return rcpp_result_gen;
+END_RCPP
+}
+// sample_geneology_demes
+List sample_geneology_demes(IntegerVector population_sizes, NumericMatrix migration_matrix, int generations, int generations_full, int generations_return, int seed, int threads, bool progress);
+RcppExport SEXP _malan_sample_geneology_demes(SEXP population_sizesSEXP, SEXP migration_matrixSEXP, SEXP generationsSEXP, SEXP generations_fullSEXP, SEXP generations_returnSEXP, SEXP seedSEXP, SEXP threadsSEXP, SEXP progressSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< IntegerVector >::type population_sizes(population_sizesSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type migration_matrix(migration_matrixSEXP);
+    Rcpp::traits::input_parameter< int >::type generations(generationsSEXP);
+    Rcpp::traits::input_parameter< int >::type generations_full(generations_fullSEXP);
+    Rcpp::traits::input_parameter< int >::type generations_return(generations_returnSEXP);
+    Rcpp::traits::input_parameter< int >::type seed(seedSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< bool >::type progress(progressSEXP);
+    rcpp_result_gen = Rcpp::wrap(sample_geneology_demes(population_sizes, migration_matrix, generations, generations_full, generations_return, seed, threads, progress));
+    return rcpp_result_gen;
+END_RCPP
+}
+// extend_geneology
+List extend_geneology(List simulation, int generations, Rcpp::Nullable< Rcpp::XPtr< std::vector<Pedigree*> > > pedigrees, bool progress);
+RcppExport SEXP _malan_extend_geneology(SEXP simulationSEXP, SEXP generationsSEXP, SEXP pedigreesSEXP, SEXP progressSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< List >::type simulation(simulationSEXP);
+    Rcpp::traits::input_parameter< int >::type generations(generationsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< Rcpp::XPtr< std::vector<Pedigree*> > > >::type pedigrees(pedigreesSEXP);
+    Rcpp::traits::input_parameter< bool >::type progress(progressSEXP);
+    rcpp_result_gen = Rcpp::wrap(extend_geneology(simulation, generations, pedigrees, progress));
+    return rcpp_result_gen;
+END_RCPP
+}
+// sample_geneology_hybrid
+List sample_geneology_hybrid(size_t population_size, int generations_exact, int generations_full, int generations_return, bool progress);
+RcppExport SEXP _malan_sample_geneology_hybrid(SEXP population_sizeSEXP, SEXP generations_exactSEXP, SEXP generations_fullSEXP, SEXP generations_returnSEXP, SEXP progressSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< size_t >::type population_size(population_sizeSEXP);
+    Rcpp::traits::input_parameter< int >::type generations_exact(generations_exactSEXP);
+    Rcpp::traits::input_parameter< int >::type generations_full(generations_fullSEXP);
+    Rcpp::traits::input_parameter< int >::type generations_return(generations_returnSEXP);
+    Rcpp::traits::input_parameter< bool >::type progress(progressSEXP);
+    rcpp_result_gen = Rcpp::wrap(sample_geneology_hybrid(population_size, generations_exact, generations_full, generations_return, progress));
+    return rcpp_result_gen;
+END_RCPP
+}
+// pedigrees_all_populate_haplotypes_hybrid
+void pedigrees_all_populate_haplotypes_hybrid(List simulation, Rcpp::XPtr< std::vector<Pedigree*> > pedigrees, Rcpp::NumericVector mutation_rates, bool progress);
+RcppExport SEXP _malan_pedigrees_all_populate_haplotypes_hybrid(SEXP simulationSEXP, SEXP pedigreesSEXP, SEXP mutation_ratesSEXP, SEXP progressSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< List >::type simulation(simulationSEXP);
+    Rcpp::traits::input_parameter< Rcpp::XPtr< std::vector<Pedigree*> > >::type pedigrees(pedigreesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type mutation_rates(mutation_ratesSEXP);
+    Rcpp::traits::input_parameter< bool >::type progress(progressSEXP);
+    pedigrees_all_populate_haplotypes_hybrid(simulation, pedigrees, mutation_rates, progress);
+    return R_NilValue;
+END_RCPP
+}
+// sample_geneology_lineages
+List sample_geneology_lineages(size_t population_size, size_t sample_size, int generations, int generations_return, bool enable_gamma_variance_extension, double gamma_parameter_shape, double gamma_parameter_scale, bool progress);
+RcppExport SEXP _malan_sample_geneology_lineages(SEXP population_sizeSEXP, SEXP sample_sizeSEXP, SEXP generationsSEXP, SEXP generations_returnSEXP, SEXP enable_gamma_variance_extensionSEXP, SEXP gamma_parameter_shapeSEXP, SEXP gamma_parameter_scaleSEXP, SEXP progressSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< size_t >::type population_size(population_sizeSEXP);
+    Rcpp::traits::input_parameter< size_t >::type sample_size(sample_sizeSEXP);
+    Rcpp::traits::input_parameter< int >::type generations(generationsSEXP);
+    Rcpp::traits::input_parameter< int >::type generations_return(generations_returnSEXP);
+    Rcpp::traits::input_parameter< bool >::type enable_gamma_variance_extension(enable_gamma_variance_extensionSEXP);
+    Rcpp::traits::input_parameter< double >::type gamma_parameter_shape(gamma_parameter_shapeSEXP);
+    Rcpp::traits::input_parameter< double >::type gamma_parameter_scale(gamma_parameter_scaleSEXP);
+    Rcpp::traits::input_parameter< bool >::type progress(progressSEXP);
+    rcpp_result_gen = Rcpp::wrap(sample_geneology_lineages(population_size, sample_size, generations, generations_return, enable_gamma_variance_extension, gamma_parameter_shape, gamma_parameter_scale, progress));
+    return rcpp_result_gen;
+END_RCPP
+}
+// sample_geneology_replicates
+RObject sample_geneology_replicates(int replicates, size_t population_size, int generations, int generations_full, int generations_return, bool enable_gamma_variance_extension, double gamma_parameter_shape, double gamma_parameter_scale, std::string summary, int seed, int threads, bool progress);
+RcppExport SEXP _malan_sample_geneology_replicates(SEXP replicatesSEXP, SEXP population_sizeSEXP, SEXP generationsSEXP, SEXP generations_fullSEXP, SEXP generations_returnSEXP, SEXP enable_gamma_variance_extensionSEXP, SEXP gamma_parameter_shapeSEXP, SEXP gamma_parameter_scaleSEXP, SEXP summarySEXP, SEXP seedSEXP, SEXP threadsSEXP, SEXP progressSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< int >::type replicates(replicatesSEXP);
+    Rcpp::traits::input_parameter< size_t >::type population_size(population_sizeSEXP);
+    Rcpp::traits::input_parameter< int >::type generations(generationsSEXP);
+    Rcpp::traits::input_parameter< int >::type generations_full(generations_fullSEXP);
+    Rcpp::traits::input_parameter< int >::type generations_return(generations_returnSEXP);
+    Rcpp::traits::input_parameter< bool >::type enable_gamma_variance_extension(enable_gamma_variance_extensionSEXP);
+    Rcpp::traits::input_parameter< double >::type gamma_parameter_shape(gamma_parameter_shapeSEXP);
+    Rcpp::traits::input_parameter< double >::type gamma_parameter_scale(gamma_parameter_scaleSEXP);
+    Rcpp::traits::input_parameter< std::string >::type summary(summarySEXP);
+    Rcpp::traits::input_parameter< int >::type seed(seedSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< bool >::type progress(progressSEXP);
+    rcpp_result_gen = Rcpp::wrap(sample_geneology_replicates(replicates, population_size, generations, generations_full, generations_return, enable_gamma_variance_extension, gamma_parameter_shape, gamma_parameter_scale, summary, seed, threads, progress));
+    return rcpp_result_gen;
+END_RCPP
+}
+// sample_geneology_stream
+List sample_geneology_stream(size_t population_size, int generations, std::string file, bool summary, bool all_fathers, bool enable_gamma_variance_extension, double gamma_parameter_shape, double gamma_parameter_scale, bool progress);
+RcppExport SEXP _malan_sample_geneology_stream(SEXP population_sizeSEXP, SEXP generationsSEXP, SEXP fileSEXP, SEXP summarySEXP, SEXP all_fathersSEXP, SEXP enable_gamma_variance_extensionSEXP, SEXP gamma_parameter_shapeSEXP, SEXP gamma_parameter_scaleSEXP, SEXP progressSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< size_t >::type population_size(population_sizeSEXP);
+    Rcpp::traits::input_parameter< int >::type generations(generationsSEXP);
+    Rcpp::traits::input_parameter< std::string >::type file(fileSEXP);
+    Rcpp::traits::input_parameter< bool >::type summary(summarySEXP);
+    Rcpp::traits::input_parameter< bool >::type all_fathers(all_fathersSEXP);
+    Rcpp::traits::input_parameter< bool >::type enable_gamma_variance_extension(enable_gamma_variance_extensionSEXP);
+    Rcpp::traits::input_parameter< double >::type gamma_parameter_shape(gamma_parameter_shapeSEXP);
+    Rcpp::traits::input_parameter< double >::type gamma_parameter_scale(gamma_parameter_scaleSEXP);
+    Rcpp::traits::input_parameter< bool >::type progress(progressSEXP);
+    rcpp_result_gen = Rcpp::wrap(sample_geneology_stream(population_size, generations, file, summary, all_fathers, enable_gamma_variance_extension, gamma_parameter_shape, gamma_parameter_scale, progress));
+    return rcpp_result_gen;
+END_RCPP
+}
+// read_geneology_stream
+IntegerMatrix read_geneology_stream(std::string file, Rcpp::Nullable<Rcpp::IntegerVector> generations);
+RcppExport SEXP _malan_read_geneology_stream(SEXP fileSEXP, SEXP generationsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type file(fileSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::IntegerVector> >::type generations(generationsSEXP);
+    rcpp_result_gen = Rcpp::wrap(read_geneology_stream(file, generations));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -337,6 +593,73 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// haplotypes_L1_matrix
+IntegerMatrix haplotypes_L1_matrix(IntegerMatrix haplotypes, int threads);
+RcppExport SEXP _malan_haplotypes_L1_matrix(SEXP haplotypesSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< IntegerMatrix >::type haplotypes(haplotypesSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(haplotypes_L1_matrix(haplotypes, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// haplotypes_L1_pairs
+DataFrame haplotypes_L1_pairs(IntegerMatrix haplotypes, int max_dist, int threads);
+RcppExport SEXP _malan_haplotypes_L1_pairs(SEXP haplotypesSEXP, SEXP max_distSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< IntegerMatrix >::type haplotypes(haplotypesSEXP);
+    Rcpp::traits::input_parameter< int >::type max_dist(max_distSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(haplotypes_L1_pairs(haplotypes, max_dist, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// pedigrees_meioses_L1_table
+DataFrame pedigrees_meioses_L1_table(Rcpp::XPtr< std::vector<Pedigree*> > pedigrees, int generation_upper_bound_in_result, int threads, bool progress);
+RcppExport SEXP _malan_pedigrees_meioses_L1_table(SEXP pedigreesSEXP, SEXP generation_upper_bound_in_resultSEXP, SEXP threadsSEXP, SEXP progressSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr< std::vector<Pedigree*> > >::type pedigrees(pedigreesSEXP);
+    Rcpp::traits::input_parameter< int >::type generation_upper_bound_in_result(generation_upper_bound_in_resultSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< bool >::type progress(progressSEXP);
+    rcpp_result_gen = Rcpp::wrap(pedigrees_meioses_L1_table(pedigrees, generation_upper_bound_in_result, threads, progress));
+    return rcpp_result_gen;
+END_RCPP
+}
+// pedigrees_haplotype_matches_ibd
+DataFrame pedigrees_haplotype_matches_ibd(Rcpp::XPtr< std::vector<Pedigree*> > pedigrees, int generation_upper_bound_in_result, int threads, bool progress);
+RcppExport SEXP _malan_pedigrees_haplotype_matches_ibd(SEXP pedigreesSEXP, SEXP generation_upper_bound_in_resultSEXP, SEXP threadsSEXP, SEXP progressSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr< std::vector<Pedigree*> > >::type pedigrees(pedigreesSEXP);
+    Rcpp::traits::input_parameter< int >::type generation_upper_bound_in_result(generation_upper_bound_in_resultSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< bool >::type progress(progressSEXP);
+    rcpp_result_gen = Rcpp::wrap(pedigrees_haplotype_matches_ibd(pedigrees, generation_upper_bound_in_result, threads, progress));
+    return rcpp_result_gen;
+END_RCPP
+}
+// population_populate_haplotypes
+void population_populate_haplotypes(Rcpp::XPtr<Population> population, Rcpp::NumericVector mutation_rates, int seed, int threads, bool progress);
+RcppExport SEXP _malan_population_populate_haplotypes(SEXP populationSEXP, SEXP mutation_ratesSEXP, SEXP seedSEXP, SEXP threadsSEXP, SEXP progressSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<Population> >::type population(populationSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type mutation_rates(mutation_ratesSEXP);
+    Rcpp::traits::input_parameter< int >::type seed(seedSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< bool >::type progress(progressSEXP);
+    population_populate_haplotypes(population, mutation_rates, seed, threads, progress);
+    return R_NilValue;
+END_RCPP
+}
 // get_individual
 Rcpp::XPtr<Individual> get_individual(Rcpp::XPtr<Population> population, int pid);
 RcppExport SEXP _malan_get_individual(SEXP populationSEXP, SEXP pidSEXP) {
@@ -381,6 +704,17 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// get_deme
+int get_deme(Rcpp::XPtr<Individual> individual);
+RcppExport SEXP _malan_get_deme(SEXP individualSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<Individual> >::type individual(individualSEXP);
+    rcpp_result_gen = Rcpp::wrap(get_deme(individual));
+    return rcpp_result_gen;
+END_RCPP
+}
 // get_pedigree_from_individual
 Rcpp::XPtr<Pedigree> get_pedigree_from_individual(Rcpp::XPtr<Individual> individual);
 RcppExport SEXP _malan_get_pedigree_from_individual(SEXP individualSEXP) {
@@ -404,6 +738,18 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// get_deme_from_pid
+Rcpp::IntegerVector get_deme_from_pid(Rcpp::XPtr<Population> population, Rcpp::IntegerVector pids);
+RcppExport SEXP _malan_get_deme_from_pid(SEXP populationSEXP, SEXP pidsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<Population> >::type population(populationSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type pids(pidsSEXP);
+    rcpp_result_gen = Rcpp::wrap(get_deme_from_pid(population, pids));
+    return rcpp_result_gen;
+END_RCPP
+}
 // get_family_info
 Rcpp::List get_family_info(Rcpp::XPtr<Individual> individual);
 RcppExport SEXP _malan_get_family_info(SEXP individualSEXP) {
@@ -514,6 +860,22 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// haplotypes_select_loci
+List haplotypes_select_loci(IntegerMatrix haplotypes, int size, std::string criterion, int beam_width, int threads, bool progress);
+RcppExport SEXP _malan_haplotypes_select_loci(SEXP haplotypesSEXP, SEXP sizeSEXP, SEXP criterionSEXP, SEXP beam_widthSEXP, SEXP threadsSEXP, SEXP progressSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< IntegerMatrix >::type haplotypes(haplotypesSEXP);
+    Rcpp::traits::input_parameter< int >::type size(sizeSEXP);
+    Rcpp::traits::input_parameter< std::string >::type criterion(criterionSEXP);
+    Rcpp::traits::input_parameter< int >::type beam_width(beam_widthSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< bool >::type progress(progressSEXP);
+    rcpp_result_gen = Rcpp::wrap(haplotypes_select_loci(haplotypes, size, criterion, beam_width, threads, progress));
+    return rcpp_result_gen;
+END_RCPP
+}
 // pop_size
 int pop_size(Rcpp::XPtr<Population> population);
 RcppExport SEXP _malan_pop_size(SEXP populationSEXP) {
@@ -572,6 +934,17 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// set_rng_compatibility
+bool set_rng_compatibility(bool compatible);
+RcppExport SEXP _malan_set_rng_compatibility(SEXP compatibleSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< bool >::type compatible(compatibleSEXP);
+    rcpp_result_gen = Rcpp::wrap(set_rng_compatibility(compatible));
+    return rcpp_result_gen;
+END_RCPP
+}
 // mixture_info_by_individuals
 Rcpp::List mixture_info_by_individuals(const Rcpp::List individuals, Rcpp::XPtr<Individual>& donor1, Rcpp::XPtr<Individual>& donor2);
 RcppExport SEXP _malan_mixture_info_by_individuals(SEXP individualsSEXP, SEXP donor1SEXP, SEXP donor2SEXP) {
@@ -720,6 +1093,194 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// sample_pids
+IntegerVector sample_pids(Rcpp::XPtr<Population> population, int size, int generation_upper_bound_in_result, bool replace, std::string weighting, std::string strata);
+RcppExport SEXP _malan_sample_pids(SEXP populationSEXP, SEXP sizeSEXP, SEXP generation_upper_bound_in_resultSEXP, SEXP replaceSEXP, SEXP weightingSEXP, SEXP strataSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<Population> >::type population(populationSEXP);
+    Rcpp::traits::input_parameter< int >::type size(sizeSEXP);
+    Rcpp::traits::input_parameter< int >::type generation_upper_bound_in_result(generation_upper_bound_in_resultSEXP);
+    Rcpp::traits::input_parameter< bool >::type replace(replaceSEXP);
+    Rcpp::traits::input_parameter< std::string >::type weighting(weightingSEXP);
+    Rcpp::traits::input_parameter< std::string >::type strata(strataSEXP);
+    rcpp_result_gen = Rcpp::wrap(sample_pids(population, size, generation_upper_bound_in_result, replace, weighting, strata));
+    return rcpp_result_gen;
+END_RCPP
+}
+// population_snapshot
+Rcpp::XPtr<PopulationSnapshot> population_snapshot(Rcpp::XPtr<Population> population, int generation_upper_bound_in_result);
+RcppExport SEXP _malan_population_snapshot(SEXP populationSEXP, SEXP generation_upper_bound_in_resultSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<Population> >::type population(populationSEXP);
+    Rcpp::traits::input_parameter< int >::type generation_upper_bound_in_result(generation_upper_bound_in_resultSEXP);
+    rcpp_result_gen = Rcpp::wrap(population_snapshot(population, generation_upper_bound_in_result));
+    return rcpp_result_gen;
+END_RCPP
+}
+// snapshot_data
+DataFrame snapshot_data(Rcpp::XPtr<PopulationSnapshot> snapshot);
+RcppExport SEXP _malan_snapshot_data(SEXP snapshotSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<PopulationSnapshot> >::type snapshot(snapshotSEXP);
+    rcpp_result_gen = Rcpp::wrap(snapshot_data(snapshot));
+    return rcpp_result_gen;
+END_RCPP
+}
+// snapshot_haplotypes
+IntegerMatrix snapshot_haplotypes(Rcpp::XPtr<PopulationSnapshot> snapshot);
+RcppExport SEXP _malan_snapshot_haplotypes(SEXP snapshotSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<PopulationSnapshot> >::type snapshot(snapshotSEXP);
+    rcpp_result_gen = Rcpp::wrap(snapshot_haplotypes(snapshot));
+    return rcpp_result_gen;
+END_RCPP
+}
+// snapshot_count_haplotype_occurrences
+int snapshot_count_haplotype_occurrences(Rcpp::XPtr<PopulationSnapshot> snapshot, IntegerVector haplotype);
+RcppExport SEXP _malan_snapshot_count_haplotype_occurrences(SEXP snapshotSEXP, SEXP haplotypeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<PopulationSnapshot> >::type snapshot(snapshotSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type haplotype(haplotypeSEXP);
+    rcpp_result_gen = Rcpp::wrap(snapshot_count_haplotype_occurrences(snapshot, haplotype));
+    return rcpp_result_gen;
+END_RCPP
+}
+// snapshot_haplotype_matches
+IntegerVector snapshot_haplotype_matches(Rcpp::XPtr<PopulationSnapshot> snapshot, IntegerVector haplotype);
+RcppExport SEXP _malan_snapshot_haplotype_matches(SEXP snapshotSEXP, SEXP haplotypeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<PopulationSnapshot> >::type snapshot(snapshotSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type haplotype(haplotypeSEXP);
+    rcpp_result_gen = Rcpp::wrap(snapshot_haplotype_matches(snapshot, haplotype));
+    return rcpp_result_gen;
+END_RCPP
+}
+// snapshot_count_haplotype_occurrences_pedigree
+int snapshot_count_haplotype_occurrences_pedigree(Rcpp::XPtr<PopulationSnapshot> snapshot, int pedigree_id, IntegerVector haplotype);
+RcppExport SEXP _malan_snapshot_count_haplotype_occurrences_pedigree(SEXP snapshotSEXP, SEXP pedigree_idSEXP, SEXP haplotypeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<PopulationSnapshot> >::type snapshot(snapshotSEXP);
+    Rcpp::traits::input_parameter< int >::type pedigree_id(pedigree_idSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type haplotype(haplotypeSEXP);
+    rcpp_result_gen = Rcpp::wrap(snapshot_count_haplotype_occurrences_pedigree(snapshot, pedigree_id, haplotype));
+    return rcpp_result_gen;
+END_RCPP
+}
+// snapshot_family_info
+List snapshot_family_info(Rcpp::XPtr<PopulationSnapshot> snapshot, int pid);
+RcppExport SEXP _malan_snapshot_family_info(SEXP snapshotSEXP, SEXP pidSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<PopulationSnapshot> >::type snapshot(snapshotSEXP);
+    Rcpp::traits::input_parameter< int >::type pid(pidSEXP);
+    rcpp_result_gen = Rcpp::wrap(snapshot_family_info(snapshot, pid));
+    return rcpp_result_gen;
+END_RCPP
+}
+// snapshot_mixture_info
+List snapshot_mixture_info(Rcpp::XPtr<PopulationSnapshot> snapshot, int donor1_pid, int donor2_pid);
+RcppExport SEXP _malan_snapshot_mixture_info(SEXP snapshotSEXP, SEXP donor1_pidSEXP, SEXP donor2_pidSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<PopulationSnapshot> >::type snapshot(snapshotSEXP);
+    Rcpp::traits::input_parameter< int >::type donor1_pid(donor1_pidSEXP);
+    Rcpp::traits::input_parameter< int >::type donor2_pid(donor2_pidSEXP);
+    rcpp_result_gen = Rcpp::wrap(snapshot_mixture_info(snapshot, donor1_pid, donor2_pid));
+    return rcpp_result_gen;
+END_RCPP
+}
+// stream_pedigrees
+List stream_pedigrees(std::string file, bool progress);
+RcppExport SEXP _malan_stream_pedigrees(SEXP fileSEXP, SEXP progressSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type file(fileSEXP);
+    Rcpp::traits::input_parameter< bool >::type progress(progressSEXP);
+    rcpp_result_gen = Rcpp::wrap(stream_pedigrees(file, progress));
+    return rcpp_result_gen;
+END_RCPP
+}
+// stream_populate_haplotypes
+void stream_populate_haplotypes(std::string file, Rcpp::NumericVector mutation_rates, std::string haplotypes_file, bool progress);
+RcppExport SEXP _malan_stream_populate_haplotypes(SEXP fileSEXP, SEXP mutation_ratesSEXP, SEXP haplotypes_fileSEXP, SEXP progressSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type file(fileSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type mutation_rates(mutation_ratesSEXP);
+    Rcpp::traits::input_parameter< std::string >::type haplotypes_file(haplotypes_fileSEXP);
+    Rcpp::traits::input_parameter< bool >::type progress(progressSEXP);
+    stream_populate_haplotypes(file, mutation_rates, haplotypes_file, progress);
+    return R_NilValue;
+END_RCPP
+}
+// stream_haplotypes
+IntegerMatrix stream_haplotypes(std::string haplotypes_file, IntegerVector individuals);
+RcppExport SEXP _malan_stream_haplotypes(SEXP haplotypes_fileSEXP, SEXP individualsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type haplotypes_file(haplotypes_fileSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type individuals(individualsSEXP);
+    rcpp_result_gen = Rcpp::wrap(stream_haplotypes(haplotypes_file, individuals));
+    return rcpp_result_gen;
+END_RCPP
+}
+// stream_count_haplotype_occurrences
+int stream_count_haplotype_occurrences(std::string haplotypes_file, IntegerVector haplotype);
+RcppExport SEXP _malan_stream_count_haplotype_occurrences(SEXP haplotypes_fileSEXP, SEXP haplotypeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type haplotypes_file(haplotypes_fileSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type haplotype(haplotypeSEXP);
+    rcpp_result_gen = Rcpp::wrap(stream_count_haplotype_occurrences(haplotypes_file, haplotype));
+    return rcpp_result_gen;
+END_RCPP
+}
+// subtree_statistics
+Rcpp::XPtr<SubtreeStatistics> subtree_statistics(Rcpp::XPtr< std::vector<Pedigree*> > pedigrees, int generation_max, bool haplotypes, int threads, bool progress);
+RcppExport SEXP _malan_subtree_statistics(SEXP pedigreesSEXP, SEXP generation_maxSEXP, SEXP haplotypesSEXP, SEXP threadsSEXP, SEXP progressSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr< std::vector<Pedigree*> > >::type pedigrees(pedigreesSEXP);
+    Rcpp::traits::input_parameter< int >::type generation_max(generation_maxSEXP);
+    Rcpp::traits::input_parameter< bool >::type haplotypes(haplotypesSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< bool >::type progress(progressSEXP);
+    rcpp_result_gen = Rcpp::wrap(subtree_statistics(pedigrees, generation_max, haplotypes, threads, progress));
+    return rcpp_result_gen;
+END_RCPP
+}
+// get_subtree_statistics
+Rcpp::DataFrame get_subtree_statistics(Rcpp::XPtr<SubtreeStatistics> statistics, Rcpp::Nullable<Rcpp::IntegerVector> pids);
+RcppExport SEXP _malan_get_subtree_statistics(SEXP statisticsSEXP, SEXP pidsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::XPtr<SubtreeStatistics> >::type statistics(statisticsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::IntegerVector> >::type pids(pidsSEXP);
+    rcpp_result_gen = Rcpp::wrap(get_subtree_statistics(statistics, pids));
+    return rcpp_result_gen;
+END_RCPP
+}
 // test_create_population
 Rcpp::XPtr<Population> test_create_population();
 RcppExport SEXP _malan_test_create_population() {
@@ -733,7 +1294,24 @@ END_RCPP
 
 static const R_CallMethodDef CallEntries[] = {
     {"_malan_build_pedigrees", (DL_FUNC) &_malan_build_pedigrees, 2},
-    {"_malan_sample_geneology", (DL_FUNC) &_malan_sample_geneology, 9},
+    {"_malan_abc_geneology_haplotypes", (DL_FUNC) &_malan_abc_geneology_haplotypes, 12},
+    {"_malan_estimate_match_distribution", (DL_FUNC) &_malan_estimate_match_distribution, 9},
+    {"_malan_run_pipeline", (DL_FUNC) &_malan_run_pipeline, 1},
+    {"_malan_query_server_run", (DL_FUNC) &_malan_query_server_run, 4},
+    {"_malan_query_server_info", (DL_FUNC) &_malan_query_server_info, 1},
+    {"_malan_query_match_counts", (DL_FUNC) &_malan_query_match_counts, 2},
+    {"_malan_query_relatives", (DL_FUNC) &_malan_query_relatives, 3},
+    {"_malan_query_distances", (DL_FUNC) &_malan_query_distances, 3},
+    {"_malan_query_server_shutdown", (DL_FUNC) &_malan_query_server_shutdown, 1},
+    {"_malan_sample_geneology", (DL_FUNC) &_malan_sample_geneology, 10},
+    {"_malan_sample_geneology_demes", (DL_FUNC) &_malan_sample_geneology_demes, 8},
+    {"_malan_extend_geneology", (DL_FUNC) &_malan_extend_geneology, 4},
+    {"_malan_sample_geneology_hybrid", (DL_FUNC) &_malan_sample_geneology_hybrid, 5},
+    {"_malan_pedigrees_all_populate_haplotypes_hybrid", (DL_FUNC) &_malan_pedigrees_all_populate_haplotypes_hybrid, 4},
+    {"_malan_sample_geneology_lineages", (DL_FUNC) &_malan_sample_geneology_lineages, 8},
+    {"_malan_sample_geneology_replicates", (DL_FUNC) &_malan_sample_geneology_replicates, 12},
+    {"_malan_sample_geneology_stream", (DL_FUNC) &_malan_sample_geneology_stream, 9},
+    {"_malan_read_geneology_stream", (DL_FUNC) &_malan_read_geneology_stream, 2},
     {"_malan_sample_geneology_varying_size", (DL_FUNC) &_malan_sample_geneology_varying_size, 7},
     {"_malan_calc_autosomal_genotype_probs", (DL_FUNC) &_malan_calc_autosomal_genotype_probs, 2},
     {"_malan_calc_autosomal_genotype_conditional_cumdist", (DL_FUNC) &_malan_calc_autosomal_genotype_conditional_cumdist, 2},
@@ -758,12 +1336,19 @@ static const R_CallMethodDef CallEntries[] = {
     {"_malan_meiotic_dist", (DL_FUNC) &_malan_meiotic_dist, 2},
     {"_malan_haplotypes_to_hashes", (DL_FUNC) &_malan_haplotypes_to_hashes, 2},
     {"_malan_split_by_haplotypes", (DL_FUNC) &_malan_split_by_haplotypes, 2},
+    {"_malan_haplotypes_L1_matrix", (DL_FUNC) &_malan_haplotypes_L1_matrix, 2},
+    {"_malan_haplotypes_L1_pairs", (DL_FUNC) &_malan_haplotypes_L1_pairs, 3},
+    {"_malan_pedigrees_meioses_L1_table", (DL_FUNC) &_malan_pedigrees_meioses_L1_table, 4},
+    {"_malan_pedigrees_haplotype_matches_ibd", (DL_FUNC) &_malan_pedigrees_haplotype_matches_ibd, 4},
+    {"_malan_population_populate_haplotypes", (DL_FUNC) &_malan_population_populate_haplotypes, 5},
     {"_malan_get_individual", (DL_FUNC) &_malan_get_individual, 2},
     {"_malan_get_pid", (DL_FUNC) &_malan_get_pid, 1},
     {"_malan_print_individual", (DL_FUNC) &_malan_print_individual, 1},
     {"_malan_get_generation", (DL_FUNC) &_malan_get_generation, 1},
+    {"_malan_get_deme", (DL_FUNC) &_malan_get_deme, 1},
     {"_malan_get_pedigree_from_individual", (DL_FUNC) &_malan_get_pedigree_from_individual, 1},
     {"_malan_get_pedigree_id_from_pid", (DL_FUNC) &_malan_get_pedigree_id_from_pid, 2},
+    {"_malan_get_deme_from_pid", (DL_FUNC) &_malan_get_deme_from_pid, 2},
     {"_malan_get_family_info", (DL_FUNC) &_malan_get_family_info, 1},
     {"_malan_get_children", (DL_FUNC) &_malan_get_children, 1},
     {"_malan_count_brothers", (DL_FUNC) &_malan_count_brothers, 1},
@@ -774,11 +1359,13 @@ static const R_CallMethodDef CallEntries[] = {
     {"_malan_count_uncles", (DL_FUNC) &_malan_count_uncles, 1},
     {"_malan_get_uncles", (DL_FUNC) &_malan_get_uncles, 1},
     {"_malan_get_cousins", (DL_FUNC) &_malan_get_cousins, 1},
+    {"_malan_haplotypes_select_loci", (DL_FUNC) &_malan_haplotypes_select_loci, 6},
     {"_malan_pop_size", (DL_FUNC) &_malan_pop_size, 1},
     {"_malan_get_individuals", (DL_FUNC) &_malan_get_individuals, 1},
     {"_malan_meioses_generation_distribution", (DL_FUNC) &_malan_meioses_generation_distribution, 2},
     {"_malan_population_size_generation", (DL_FUNC) &_malan_population_size_generation, 2},
     {"_malan_pedigree_size_generation", (DL_FUNC) &_malan_pedigree_size_generation, 2},
+    {"_malan_set_rng_compatibility", (DL_FUNC) &_malan_set_rng_compatibility, 1},
     {"_malan_mixture_info_by_individuals", (DL_FUNC) &_malan_mixture_info_by_individuals, 3},
     {"_malan_mixture_info_by_individuals_3pers", (DL_FUNC) &_malan_mixture_info_by_individuals_3pers, 4},
     {"_malan_get_pedigree_id", (DL_FUNC) &_malan_get_pedigree_id, 1},
@@ -792,6 +1379,21 @@ static const R_CallMethodDef CallEntries[] = {
     {"_malan_get_pedigree_edgelist", (DL_FUNC) &_malan_get_pedigree_edgelist, 1},
     {"_malan_get_pedigree_as_graph", (DL_FUNC) &_malan_get_pedigree_as_graph, 1},
     {"_malan_get_pedigrees_tidy", (DL_FUNC) &_malan_get_pedigrees_tidy, 1},
+    {"_malan_sample_pids", (DL_FUNC) &_malan_sample_pids, 6},
+    {"_malan_population_snapshot", (DL_FUNC) &_malan_population_snapshot, 2},
+    {"_malan_snapshot_data", (DL_FUNC) &_malan_snapshot_data, 1},
+    {"_malan_snapshot_haplotypes", (DL_FUNC) &_malan_snapshot_haplotypes, 1},
+    {"_malan_snapshot_count_haplotype_occurrences", (DL_FUNC) &_malan_snapshot_count_haplotype_occurrences, 2},
+    {"_malan_snapshot_haplotype_matches", (DL_FUNC) &_malan_snapshot_haplotype_matches, 2},
+    {"_malan_snapshot_count_haplotype_occurrences_pedigree", (DL_FUNC) &_malan_snapshot_count_haplotype_occurrences_pedigree, 3},
+    {"_malan_snapshot_family_info", (DL_FUNC) &_malan_snapshot_family_info, 2},
+    {"_malan_snapshot_mixture_info", (DL_FUNC) &_malan_snapshot_mixture_info, 3},
+    {"_malan_stream_pedigrees", (DL_FUNC) &_malan_stream_pedigrees, 2},
+    {"_malan_stream_populate_haplotypes", (DL_FUNC) &_malan_stream_populate_haplotypes, 4},
+    {"_malan_stream_haplotypes", (DL_FUNC) &_malan_stream_haplotypes, 2},
+    {"_malan_stream_count_haplotype_occurrences", (DL_FUNC) &_malan_stream_count_haplotype_occurrences, 2},
+    {"_malan_subtree_statistics", (DL_FUNC) &_malan_subtree_statistics, 5},
+    {"_malan_get_subtree_statistics", (DL_FUNC) &_malan_get_subtree_statistics, 2},
     {"_malan_test_create_population", (DL_FUNC) &_malan_test_create_population, 0},
     {NULL, NULL, 0}
 };
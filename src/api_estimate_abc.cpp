@@ -0,0 +1,496 @@
+/**
+ api_estimate_abc.cpp
+ Purpose: Logic for approximate Bayesian computation (ABC) of mutation rates and demography.
+ Details: API between R user and C++ logic.
+
+ @author Mikkel Meyer Andersen
+ */
+
+#include <RcppArmadillo.h>
+
+// [[Rcpp::depends(RcppProgress)]]
+// [[Rcpp::depends(RcppArmadillo)]]
+
+#include <progress.hpp>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+#include "malan_types.h"
+
+using namespace Rcpp;
+
+#define ABC_SUMMARY_DIVERSITY 0
+#define ABC_SUMMARY_SINGLETONS 1
+#define ABC_SUMMARY_DISTINCT 2
+#define ABC_SUMMARY_VARIANCE 3
+
+/*
+Memory for simulating a draw, kept by each thread and reset (but not freed)
+between draws, so no allocations are made once the largest draw has been simulated.
+*/
+struct ABCWorkspace {
+  // position of the father (in the next older generation) of each man in the geneology,
+  // generation by generation: generation g is [generation_begin[g], generation_begin[g + 1])
+  std::vector<int> fathers;
+  std::vector<size_t> generation_begin;
+  std::unordered_map<int, int> drawn_fathers;
+
+  std::vector<double> mutation_rates;
+  std::vector<double> mutation_rates_half;
+  std::vector<double> u;
+  std::vector<int> haplotypes;
+  std::vector<int> fathers_haplotypes;
+  std::vector<int> order;
+
+  void reset() {
+    fathers.clear();
+    generation_begin.clear();
+  }
+};
+
+/*
+Summary statistics of n haplotypes (row by row) in the order of summaries,
+where the variance is a statistic per locus.
+*/
+static void abc_summaries(const int* haplotypes, size_t n, size_t loci,
+                          const std::vector<int>& summaries, std::vector<int>& order, double* res) {
+  order.resize(n);
+
+  for (size_t i = 0; i < n; ++i) {
+    order[i] = i;
+  }
+
+  std::sort(order.begin(), order.end(), [&](int a, int b) {
+    return std::lexicographical_compare(haplotypes + (size_t)a*loci, haplotypes + (size_t)(a + 1)*loci,
+                                        haplotypes + (size_t)b*loci, haplotypes + (size_t)(b + 1)*loci);
+  });
+
+  // identical haplotypes are now adjacent
+  double distinct = 0.0;
+  double singletons = 0.0;
+  double sum_squares = 0.0;
+  size_t run = 0;
+
+  for (size_t k = 0; k < n; ++k) {
+    run += 1;
+
+    if (k + 1 == n || !std::equal(haplotypes + (size_t)order[k]*loci, haplotypes + (size_t)(order[k] + 1)*loci,
+                                  haplotypes + (size_t)order[k + 1]*loci)) {
+      distinct += 1.0;
+      singletons += (run == 1) ? 1.0 : 0.0;
+      sum_squares += (double)run*(double)run;
+      run = 0;
+    }
+  }
+
+  double N = (double)n;
+  size_t j = 0;
+
+  for (auto summary : summaries) {
+    if (summary == ABC_SUMMARY_DIVERSITY) {
+      res[j++] = (n > 1) ? (N / (N - 1.0))*(1.0 - sum_squares / (N*N)) : 0.0;
+    } else if (summary == ABC_SUMMARY_SINGLETONS) {
+      res[j++] = singletons / N;
+    } else if (summary == ABC_SUMMARY_DISTINCT) {
+      res[j++] = distinct / N;
+    } else {
+      for (size_t loc = 0; loc < loci; ++loc) {
+        double sum = 0.0;
+        double sum_sq = 0.0;
+
+        for (size_t i = 0; i < n; ++i) {
+          double h = (double)haplotypes[i*loci + loc];
+          sum += h;
+          sum_sq += h*h;
+        }
+
+        res[j++] = (n > 1) ? (sum_sq - sum*sum / N) / (N - 1.0) : 0.0;
+      }
+    }
+  }
+}
+
+/*
+Simulate the geneology of n men in the end generation (backwards) with
+population size population_size*exp(-growth_rate*g) in generation g (at least 1),
+until generations (or, if -1, 1 founder), and then their haplotypes (forwards)
+from founders with haplotype 0 (the haplotypes are in ws.haplotypes, row by row).
+Only the ancestors of the n men are simulated, as in sample_geneology_lineages().
+*/
+static void abc_simulate_draw(size_t n, size_t loci, int generations,
+                              double population_size, double growth_rate,
+                              ABCWorkspace& ws, StreamRNG& rng) {
+  ws.reset();
+  ws.generation_begin.push_back(0);
+
+  size_t lineages = n;
+  int generation = 1;
+
+  // a single lineage: the mutations in his ancestors are shared by all, and do not matter
+  while ((generations == -1 || generation < generations) && lineages > 1) {
+    double N = std::max(1.0, std::round(population_size * std::exp(-growth_rate * (double)generation)));
+    ws.drawn_fathers.clear();
+
+    for (size_t i = 0; i < lineages; ++i) {
+      int father_i = rng.unif_rand() * N;
+      auto got = ws.drawn_fathers.emplace(father_i, (int)ws.drawn_fathers.size());
+      ws.fathers.push_back(got.first->second);
+    }
+
+    ws.generation_begin.push_back(ws.fathers.size());
+    lineages = ws.drawn_fathers.size();
+    generation += 1;
+  }
+
+  // founders
+  ws.fathers_haplotypes.assign(lineages * loci, 0);
+
+  const double* mu = ws.mutation_rates.data();
+  const double* mu_half = ws.mutation_rates_half.data();
+
+  for (size_t g = ws.generation_begin.size() - 1; g-- > 0; ) {
+    size_t begin = ws.generation_begin[g];
+    size_t men = ws.generation_begin[g + 1] - begin;
+
+    ws.haplotypes.resize(men * loci);
+    ws.u.resize(men * loci);
+    rng.unif_rand_fill(ws.u.data(), men * loci);
+
+    // one uniform per locus, as in population_populate_haplotypes()
+    for (size_t k = 0; k < men; ++k) {
+      int* h = ws.haplotypes.data() + k*loci;
+      const int* h_father = ws.fathers_haplotypes.data() + (size_t)ws.fathers[begin + k]*loci;
+      const double* u_k = ws.u.data() + k*loci;
+
+      for (size_t loc = 0; loc < loci; ++loc) {
+        int down = (u_k[loc] < mu_half[loc]);
+        int up = (u_k[loc] < mu[loc]) - down;
+        h[loc] = h_father[loc] - down + up;
+      }
+    }
+
+    ws.fathers_haplotypes.swap(ws.haplotypes);
+  }
+
+  ws.haplotypes.swap(ws.fathers_haplotypes);
+}
+
+// uniform on the log scale between lower and upper
+static inline double draw_log_uniform(double lower, double upper, StreamRNG& rng) {
+  return std::exp(std::log(lower) + rng.unif_rand()*(std::log(upper) - std::log(lower)));
+}
+
+//' Approximate Bayesian computation of mutation rates and demography
+//'
+//' Approximate Bayesian computation (ABC) by rejection for the mutation rates and
+//' population size trajectory given a database of haplotypes, `observed`, of a sample of men.
+//'
+//' For each of `draws` draws, the parameters are drawn from the priors:
+//' \itemize{
+//'   \item the end generation population size, \eqn{N_0}, uniform on the log scale in `population_size_prior`,
+//'   \item the growth rate, \eqn{r}, uniform in `growth_rate_prior`,
+//'   \item the mutation rate of locus `l`, uniform on the log scale between
+//'   `mutation_rates_lower[l]` and `mutation_rates_upper[l]` (recycled if of length 1).
+//' }
+//' Then the geneology of `nrow(observed)` men in the end generation is simulated as
+//' in [sample_geneology_lineages()] (standard Wright-Fisher), where the population size in
+//' generation \eqn{g} (0 is the end generation) is \eqn{N_0 e^{-r g}} (rounded, and at least 1),
+//' and haplotypes are populated as in [population_populate_haplotypes()] (founders get haplotype 0).
+//' The summary statistics of the simulated haplotypes are compared to those of `observed`.
+//'
+//' The summary statistics are chosen by `summaries`:
+//' `"diversity"` (haplotype diversity, \eqn{n/(n-1) (1 - \sum_i p_i^2)} where \eqn{p_i} are the haplotype frequencies),
+//' `"singletons"` (fraction of haplotypes observed once),
+//' `"distinct"` (fraction of distinct haplotypes) and
+//' `"variance"` (variance of the alleles, for each locus).
+//' The distance between a draw and `observed` is the Euclidean distance between
+//' their summary statistics, each divided by its standard deviation over all draws.
+//' The `ceiling(tolerance * draws)` draws with the smallest distances are accepted.
+//'
+//' Draws are simulated in parallel; each thread reuses its memory from draw to draw and
+//' only the parameters and summary statistics of a draw are kept.
+//' Each draw uses its own random number stream derived from `seed`,
+//' so results only depend on `seed` and not on the number of threads.
+//'
+//' @param observed Integer matrix with the observed haplotypes, one per row
+//' @param draws Number of draws from the priors
+//' @param generations Number of generations to simulate (-1 for simulate to 1 founder)
+//' @param population_size_prior Range of end generation population sizes (at least `nrow(observed)`)
+//' @param mutation_rates_lower Lower bounds for the mutation rates
+//' @param mutation_rates_upper Upper bounds for the mutation rates
+//' @param growth_rate_prior Range of growth rates per generation (the default is constant population size)
+//' @param summaries Summary statistics, see details
+//' @param tolerance Fraction of draws to accept
+//' @param seed Seed for the random number streams; `NA` means draw from R's random number generator.
+//' @param threads Number of threads; 0 means the OpenMP default.
+//' @param progress Show progress
+//'
+//' @return A list with the accepted draws, nearest first:
+//' \itemize{
+//'   \item `parameters`: matrix with columns `population_size`, `growth_rate` and `mutation_rate_1`, ...
+//'   \item `summaries`: matrix with the summary statistics of the accepted draws.
+//'   \item `distance`: distance to `observed`.
+//'   \item `observed`: the summary statistics of `observed`.
+//' }
+//'
+//' @seealso [sample_geneology_varying_size()], [sample_geneology_lineages()] and [population_populate_haplotypes()].
+//'
+//' @export
+// [[Rcpp::export]]
+List abc_geneology_haplotypes(IntegerMatrix observed,
+                              int draws,
+                              int generations,
+                              NumericVector population_size_prior,
+                              NumericVector mutation_rates_lower,
+                              NumericVector mutation_rates_upper,
+                              NumericVector growth_rate_prior = NumericVector::create(0.0, 0.0),
+                              CharacterVector summaries = CharacterVector::create("diversity", "singletons", "variance"),
+                              double tolerance = 0.01,
+                              int seed = NA_INTEGER,
+                              int threads = 0,
+                              bool progress = true) {
+
+  size_t n = observed.nrow();
+  size_t loci = observed.ncol();
+
+  if (n < 1 || loci < 1) {
+    Rcpp::stop("observed must have at least one row and one column");
+  }
+
+  if (draws < 1) {
+    Rcpp::stop("draws must be at least 1");
+  }
+
+  if (generations < -1 || generations == 0) {
+    Rcpp::stop("Please specify generations as -1 (for simulation to 1 founder) or > 0");
+  }
+
+  if (population_size_prior.size() != 2 || population_size_prior[0] < (double)n ||
+      population_size_prior[1] < population_size_prior[0]) {
+    Rcpp::stop("population_size_prior must be c(lower, upper) with nrow(observed) <= lower <= upper");
+  }
+
+  if (growth_rate_prior.size() != 2 || growth_rate_prior[1] < growth_rate_prior[0]) {
+    Rcpp::stop("growth_rate_prior must be c(lower, upper) with lower <= upper");
+  }
+
+  std::vector<double> mu_lower(loci);
+  std::vector<double> mu_upper(loci);
+
+  if ((mutation_rates_lower.size() != 1 && mutation_rates_lower.size() != loci) ||
+      (mutation_rates_upper.size() != 1 && mutation_rates_upper.size() != loci)) {
+    Rcpp::stop("mutation_rates_lower and mutation_rates_upper must have length 1 or ncol(observed)");
+  }
+
+  for (size_t loc = 0; loc < loci; ++loc) {
+    mu_lower[loc] = mutation_rates_lower[(mutation_rates_lower.size() == 1) ? 0 : loc];
+    mu_upper[loc] = mutation_rates_upper[(mutation_rates_upper.size() == 1) ? 0 : loc];
+
+    if (mu_lower[loc] <= 0.0 || mu_upper[loc] < mu_lower[loc] || mu_upper[loc] > 1.0) {
+      Rcpp::stop("Mutation rates must have 0 < lower <= upper <= 1");
+    }
+  }
+
+  std::vector<int> summary_types;
+  std::vector<std::string> summary_names;
+
+  for (size_t s = 0; s < summaries.size(); ++s) {
+    std::string summary = Rcpp::as<std::string>(summaries[s]);
+
+    if (summary == "diversity") {
+      summary_types.push_back(ABC_SUMMARY_DIVERSITY);
+      summary_names.push_back(summary);
+    } else if (summary == "singletons") {
+      summary_types.push_back(ABC_SUMMARY_SINGLETONS);
+      summary_names.push_back(summary);
+    } else if (summary == "distinct") {
+      summary_types.push_back(ABC_SUMMARY_DISTINCT);
+      summary_names.push_back(summary);
+    } else if (summary == "variance") {
+      summary_types.push_back(ABC_SUMMARY_VARIANCE);
+
+      for (size_t loc = 0; loc < loci; ++loc) {
+        summary_names.push_back("variance_" + std::to_string(loc + 1));
+      }
+    } else {
+      Rcpp::stop("summaries must be 'diversity', 'singletons', 'distinct' or 'variance'");
+    }
+  }
+
+  size_t stats = summary_names.size();
+
+  if (stats == 0) {
+    Rcpp::stop("At least one summary statistic must be used");
+  }
+
+  if (tolerance <= 0.0 || tolerance > 1.0) {
+    Rcpp::stop("tolerance must be > 0 and <= 1");
+  }
+
+  if (threads < 0) {
+    Rcpp::stop("threads must be >= 0");
+  }
+
+#ifdef _OPENMP
+  if (threads == 0) {
+    threads = omp_get_max_threads();
+  }
+#else
+  threads = 1;
+#endif
+
+  // observed haplotypes row by row, as the simulated
+  std::vector<int> observed_haplotypes(n * loci);
+
+  for (size_t loc = 0; loc < loci; ++loc) {
+    for (size_t i = 0; i < n; ++i) {
+      if (observed(i, loc) == NA_INTEGER) {
+        Rcpp::stop("observed must not contain NA");
+      }
+
+      observed_haplotypes[i*loci + loc] = observed(i, loc);
+    }
+  }
+
+  std::vector<double> observed_stats(stats);
+  std::vector<int> order;
+  abc_summaries(observed_haplotypes.data(), n, loci, summary_types, order, observed_stats.data());
+
+  size_t parameters = 2 + loci;
+  std::vector<double> draw_parameters((size_t)draws * parameters);
+  std::vector<double> draw_stats((size_t)draws * stats);
+
+  uint64_t base_seed = (seed == NA_INTEGER) ? draw_seed_from_R() : (uint64_t)seed;
+
+  Progress progress_bar(draws, progress);
+  bool aborted = false;
+
+  #pragma omp parallel num_threads(threads)
+  {
+    ABCWorkspace ws; // per thread
+    ws.mutation_rates.resize(loci);
+    ws.mutation_rates_half.resize(loci);
+
+    #pragma omp for schedule(dynamic, 1)
+    for (int d = 0; d < draws; ++d) {
+      if (aborted) {
+        continue;
+      }
+
+      StreamRNG rng(base_seed, d);
+      double* theta = draw_parameters.data() + (size_t)d*parameters;
+
+      theta[0] = std::round(draw_log_uniform(population_size_prior[0], population_size_prior[1], rng));
+      theta[1] = growth_rate_prior[0] + rng.unif_rand()*(growth_rate_prior[1] - growth_rate_prior[0]);
+
+      for (size_t loc = 0; loc < loci; ++loc) {
+        theta[2 + loc] = draw_log_uniform(mu_lower[loc], mu_upper[loc], rng);
+        ws.mutation_rates[loc] = theta[2 + loc];
+        ws.mutation_rates_half[loc] = 0.5*theta[2 + loc];
+      }
+
+      abc_simulate_draw(n, loci, generations, theta[0], theta[1], ws, rng);
+      abc_summaries(ws.haplotypes.data(), n, loci, summary_types, ws.order, draw_stats.data() + (size_t)d*stats);
+
+      // only master thread checks (and the progress bar is thread safe)
+      if (Progress::check_abort()) {
+        aborted = true;
+      }
+
+      if (progress) {
+        progress_bar.increment();
+      }
+    }
+  }
+
+  if (aborted) {
+    Rcpp::stop("Aborted");
+  }
+
+  // scale each statistic by its standard deviation over the draws (if not 0)
+  std::vector<double> scale(stats, 1.0);
+
+  for (size_t s = 0; s < stats; ++s) {
+    double sum = 0.0;
+    double sum_sq = 0.0;
+
+    for (int d = 0; d < draws; ++d) {
+      double x = draw_stats[(size_t)d*stats + s];
+      sum += x;
+      sum_sq += x*x;
+    }
+
+    double var = (draws > 1) ? (sum_sq - sum*sum / draws) / (draws - 1.0) : 0.0;
+
+    if (var > 0.0) {
+      scale[s] = std::sqrt(var);
+    }
+  }
+
+  std::vector<double> distance(draws);
+  std::vector<int> ranking(draws);
+
+  for (int d = 0; d < draws; ++d) {
+    double dist = 0.0;
+
+    for (size_t s = 0; s < stats; ++s) {
+      double z = (draw_stats[(size_t)d*stats + s] - observed_stats[s]) / scale[s];
+      dist += z*z;
+    }
+
+    distance[d] = std::sqrt(dist);
+    ranking[d] = d;
+  }
+
+  int accepted = std::min(draws, std::max(1, (int)std::ceil(tolerance * draws)));
+
+  // ties by draw, so the result does not depend on the sort
+  std::partial_sort(ranking.begin(), ranking.begin() + accepted, ranking.end(), [&](int a, int b) {
+    return (distance[a] != distance[b]) ? distance[a] < distance[b] : a < b;
+  });
+
+  NumericMatrix res_parameters(accepted, parameters);
+  NumericMatrix res_summaries(accepted, stats);
+  NumericVector res_distance(accepted);
+
+  for (int k = 0; k < accepted; ++k) {
+    int d = ranking[k];
+
+    for (size_t p = 0; p < parameters; ++p) {
+      res_parameters(k, p) = draw_parameters[(size_t)d*parameters + p];
+    }
+
+    for (size_t s = 0; s < stats; ++s) {
+      res_summaries(k, s) = draw_stats[(size_t)d*stats + s];
+    }
+
+    res_distance[k] = distance[d];
+  }
+
+  CharacterVector parameter_names(parameters);
+  parameter_names[0] = "population_size";
+  parameter_names[1] = "growth_rate";
+
+  for (size_t loc = 0; loc < loci; ++loc) {
+    parameter_names[2 + loc] = "mutation_rate_" + std::to_string(loc + 1);
+  }
+
+  colnames(res_parameters) = parameter_names;
+  colnames(res_summaries) = Rcpp::wrap(summary_names);
+
+  NumericVector res_observed = Rcpp::wrap(observed_stats);
+  res_observed.attr("names") = Rcpp::wrap(summary_names);
+
+  return List::create(
+    Named("parameters") = res_parameters,
+    Named("summaries") = res_summaries,
+    Named("distance") = res_distance,
+    Named("observed") = res_observed);
+}
+
@@ -0,0 +1,312 @@
+/**
+ api_estimate_matches.cpp
+ Purpose: Logic to estimate match probabilities by redrawing haplotypes.
+ Details: API between R user and C++ logic.
+
+ @author Mikkel Meyer Andersen
+ */
+
+#include <RcppArmadillo.h>
+
+// [[Rcpp::depends(RcppProgress)]]
+// [[Rcpp::depends(RcppArmadillo)]]
+
+#include <progress.hpp>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <unordered_set>
+
+#include "malan_types.h"
+
+using namespace Rcpp;
+
+// hist[s][k] += 1, growing hist[s] as needed
+void histogram_add(std::vector< std::vector<int> >& hist, size_t s, size_t k, int count = 1) {
+  if (k >= hist[s].size()) {
+    hist[s].resize(k + 1, 0);
+  }
+
+  hist[s][k] += count;
+}
+
+void histogram_merge(std::vector< std::vector<int> >& hist, const std::vector< std::vector<int> >& other) {
+  for (size_t s = 0; s < other.size(); ++s) {
+    for (size_t k = 0; k < other[s].size(); ++k) {
+      if (other[s][k] > 0) {
+        histogram_add(hist, s, k, other[s][k]);
+      }
+    }
+  }
+}
+
+Rcpp::IntegerMatrix histogram_to_matrix(const std::vector< std::vector<int> >& hist) {
+  size_t cols = 0;
+
+  for (auto& h : hist) {
+    cols = std::max(cols, h.size());
+  }
+
+  Rcpp::IntegerMatrix res(hist.size(), cols);
+  Rcpp::CharacterVector names(cols);
+
+  for (size_t k = 0; k < cols; ++k) {
+    names[k] = std::to_string(k);
+  }
+
+  colnames(res) = names;
+
+  for (size_t s = 0; s < hist.size(); ++s) {
+    for (size_t k = 0; k < hist[s].size(); ++k) {
+      res(s, k) = hist[s][k];
+    }
+  }
+
+  return res;
+}
+
+//' Estimate match distributions by redrawing haplotypes
+//'
+//' For each of `replicates` replicates, haplotypes are redrawn
+//' (as by [pedigrees_all_populate_haplotypes()]) in the pedigrees,
+//' and for each suspect the live individuals with the suspect's haplotype are counted.
+//' The genealogy is fixed: it is compiled once into a flat index
+//' (and meiotic distances between suspects and their relatives are computed once),
+//' only the haplotypes are redrawn.
+//' Haplotypes already populated in the pedigrees are neither used nor changed.
+//'
+//' If `only_suspect_pedigrees` is `TRUE`, only the pedigrees containing a suspect
+//' are indexed and redrawn (which is typically much faster),
+//' and only matches in the suspect's own pedigree are counted.
+//' Else all pedigrees are redrawn and matches are also counted in the entire population
+//' (all individuals in `pedigrees`).
+//'
+//' Replicates are run in parallel. As for [sample_geneology_replicates()],
+//' each replicate uses its own random number stream derived from `seed`,
+//' so results only depend on `seed` and not on the number of threads.
+//'
+//' Note, that pedigrees must first have been inferred by [build_pedigrees()].
+//'
+//' @param suspects List of individuals
+//' @param pedigrees Pedigree list (containing the suspects)
+//' @param mutation_rates Vector with mutation rates
+//' @param replicates Number of times to redraw haplotypes
+//' @param generation_upper_bound_in_result Only consider matches in
+//' generation 0, 1, ... generation_upper_bound_in_result.
+//' -1 means disabled, consider all generations.
+//' End generation is generation 0.
+//' Second last generation is 1.
+//' And so on.
+//' @param only_suspect_pedigrees Only redraw haplotypes in (and count matches in) the pedigrees of the suspects.
+//' @param seed Seed for the random number streams; `NA` means draw from R's random number generator.
+//' @param threads Number of threads; 0 means the OpenMP default.
+//' @param progress Show progress
+//'
+//' @return A list with integer matrices, all with a row per suspect:
+//' `matches_pedigree` (entry `[s, k + 1]` is the number of replicates in which
+//' suspect `s` had `k` matches in his pedigree),
+//' `meioses` (entry `[s, m + 1]` is the number of matches, summed over replicates,
+//' at `m` meioses from suspect `s`) and,
+//' if `only_suspect_pedigrees` is `FALSE`,
+//' `matches_population` (as `matches_pedigree`, but for matches in the entire population).
+//' The matches do not include the suspect himself.
+//'
+//' @seealso [pedigree_haplotype_matches_in_pedigree_meiosis_L1_dists()] and
+//' [count_haplotype_occurrences_pedigree()].
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::List estimate_match_distribution(Rcpp::ListOf< Rcpp::XPtr<Individual> > suspects,
+                                       Rcpp::XPtr< std::vector<Pedigree*> > pedigrees,
+                                       Rcpp::NumericVector mutation_rates,
+                                       int replicates,
+                                       int generation_upper_bound_in_result = -1,
+                                       bool only_suspect_pedigrees = true,
+                                       int seed = NA_INTEGER,
+                                       int threads = 0,
+                                       bool progress = true) {
+
+  if (replicates < 1) {
+    Rcpp::stop("replicates must be at least 1");
+  }
+
+  if (threads < 0) {
+    Rcpp::stop("threads must be >= 0");
+  }
+
+  std::vector<double> mut_rates = Rcpp::as< std::vector<double> >(mutation_rates);
+  size_t loci = mut_rates.size();
+
+  if (loci == 0) {
+    Rcpp::stop("mutation_rates must have at least one locus");
+  }
+
+  size_t n_suspects = suspects.size();
+  std::vector<Individual*> suspect_individuals(n_suspects);
+
+  for (size_t s = 0; s < n_suspects; ++s) {
+    Individual* suspect = suspects[s];
+
+    if (!(suspect->pedigree_is_set())) {
+      Rcpp::stop("Pedigree not set for suspect, did you call build_pedigrees()?");
+    }
+
+    suspect_individuals[s] = suspect;
+  }
+
+  // Compile the relevant pedigrees
+  std::vector<Pedigree*> indexed_pedigrees;
+
+  if (only_suspect_pedigrees) {
+    std::unordered_set<Pedigree*> seen;
+
+    for (auto suspect : suspect_individuals) {
+      if (seen.insert(suspect->get_pedigree()).second) {
+        indexed_pedigrees.push_back(suspect->get_pedigree());
+      }
+    }
+  } else {
+    indexed_pedigrees = (*pedigrees);
+  }
+
+  PedigreeIndex index(indexed_pedigrees);
+
+  std::vector<int> suspect_index(n_suspects);
+
+  for (size_t s = 0; s < n_suspects; ++s) {
+    suspect_index[s] = index.get_index(suspect_individuals[s]);
+
+    if (suspect_index[s] == -1) {
+      Rcpp::stop("Suspect not in pedigrees");
+    }
+  }
+
+  // Live individuals in the population; only needed if counting in population
+  std::vector<int> live;
+
+  if (!only_suspect_pedigrees) {
+    for (int i = 0; i < index.size(); ++i) {
+      if (generation_upper_bound_in_result == -1 || index.get_generation(i) <= generation_upper_bound_in_result) {
+        live.push_back(i);
+      }
+    }
+  }
+
+  // Live relatives (and meiotic distance) of each suspect, computed once
+  std::vector< std::vector<int> > relatives(n_suspects);
+  std::vector< std::vector<int> > relatives_meioses(n_suspects);
+
+  for (size_t s = 0; s < n_suspects; ++s) {
+    int p = index.get_pedigree(suspect_index[s]);
+
+    for (int i = index.get_pedigree_begin(p); i < index.get_pedigree_end(p); ++i) {
+      if (i == suspect_index[s]) {
+        continue;
+      }
+
+      if (generation_upper_bound_in_result != -1 && index.get_generation(i) > generation_upper_bound_in_result) {
+        continue;
+      }
+
+      relatives[s].push_back(i);
+      relatives_meioses[s].push_back(index.meiosis_dist(suspect_index[s], i));
+    }
+  }
+
+  uint64_t base_seed = (seed == NA_INTEGER) ? draw_seed_from_R() : (uint64_t)seed;
+
+#ifdef _OPENMP
+  if (threads == 0) {
+    threads = omp_get_max_threads();
+  }
+#else
+  threads = 1;
+#endif
+
+  std::vector< std::vector<int> > hist_matches_pedigree(n_suspects);
+  std::vector< std::vector<int> > hist_meioses(n_suspects);
+  std::vector< std::vector<int> > hist_matches_population(n_suspects);
+
+  Progress progress_bar(replicates, progress);
+  bool aborted = false;
+
+  #pragma omp parallel num_threads(threads)
+  {
+    // per thread buffers and histograms
+    std::vector<int> haplotypes;
+    std::vector< std::vector<int> > thread_matches_pedigree(n_suspects);
+    std::vector< std::vector<int> > thread_meioses(n_suspects);
+    std::vector< std::vector<int> > thread_matches_population(n_suspects);
+
+    #pragma omp for schedule(dynamic, 1)
+    for (int r = 0; r < replicates; ++r) {
+      if (aborted) {
+        continue;
+      }
+
+      StreamRNG rng(base_seed, r);
+      index.populate_haplotypes(haplotypes, mut_rates, &rng);
+
+      for (size_t s = 0; s < n_suspects; ++s) {
+        const int* h = &(haplotypes[suspect_index[s] * loci]);
+        int matches_pedigree = 0;
+
+        for (size_t k = 0; k < relatives[s].size(); ++k) {
+          const int* h_rel = &(haplotypes[relatives[s][k] * loci]);
+
+          if (std::equal(h, h + loci, h_rel)) {
+            matches_pedigree += 1;
+            histogram_add(thread_meioses, s, relatives_meioses[s][k]);
+          }
+        }
+
+        histogram_add(thread_matches_pedigree, s, matches_pedigree);
+
+        if (!only_suspect_pedigrees) {
+          int matches_population = 0;
+
+          for (auto i : live) {
+            if (i != suspect_index[s] && std::equal(h, h + loci, &(haplotypes[i * loci]))) {
+              matches_population += 1;
+            }
+          }
+
+          histogram_add(thread_matches_population, s, matches_population);
+        }
+      }
+
+      // only master thread checks (and the progress bar is thread safe)
+      if (Progress::check_abort()) {
+        aborted = true;
+      }
+
+      if (progress) {
+        progress_bar.increment();
+      }
+    }
+
+    #pragma omp critical
+    {
+      histogram_merge(hist_matches_pedigree, thread_matches_pedigree);
+      histogram_merge(hist_meioses, thread_meioses);
+      histogram_merge(hist_matches_population, thread_matches_population);
+    }
+  }
+
+  if (aborted) {
+    Rcpp::stop("Aborted");
+  }
+
+  Rcpp::List res;
+  res["matches_pedigree"] = histogram_to_matrix(hist_matches_pedigree);
+  res["meioses"] = histogram_to_matrix(hist_meioses);
+
+  if (!only_suspect_pedigrees) {
+    res["matches_population"] = histogram_to_matrix(hist_matches_population);
+  }
+
+  return res;
+}
+
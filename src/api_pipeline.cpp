@@ -0,0 +1,456 @@
+/**
+ api_pipeline.cpp
+ Purpose: Logic to run the full simulation chain (population, haplotypes, matches) in C++.
+ Details: API between R user and C++ logic.
+
+ @author Mikkel Meyer Andersen
+ */
+
+#include <RcppArmadillo.h>
+
+// [[Rcpp::depends(RcppProgress)]]
+// [[Rcpp::depends(RcppArmadillo)]]
+
+#include <progress.hpp>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "malan_types.h"
+#include "api_simulate.h"
+
+using namespace Rcpp;
+
+// Result of one replicate; filled in worker threads, wrapped by the main thread
+struct PipelineReplicateResult {
+  int generations = 0;
+  int founders = 0;
+  int individuals = 0;
+  int live_individuals = 0;
+  int live_haplotypes = 0;
+
+  std::vector<int> suspect_pid;
+  std::vector<int> suspect_matches;
+  std::vector<int> suspect_matches_pedigree;
+
+  // meioses[m] = number of (suspect, matching live individual in pedigree) pairs m meioses apart
+  std::vector<int> meioses;
+};
+
+const std::vector<std::string> PIPELINE_PARAMETERS = {
+  "population_size", "generations", "generations_full", "generations_return",
+  "enable_gamma_variance_extension", "gamma_parameter_shape", "gamma_parameter_scale",
+  "mutation_rates", "founder_haplotypes", "sample_size",
+  "replicates", "seed", "threads", "progress"
+};
+
+template <typename T>
+T pipeline_parameter(List& parameters, const std::string& name, T default_value) {
+  if (!parameters.containsElementNamed(name.c_str())) {
+    return default_value;
+  }
+
+  return Rcpp::as<T>(parameters[name]);
+}
+
+template <typename T>
+T pipeline_parameter_required(List& parameters, const std::string& name) {
+  if (!parameters.containsElementNamed(name.c_str())) {
+    Rcpp::stop("Parameter '" + name + "' is required");
+  }
+
+  return Rcpp::as<T>(parameters[name]);
+}
+
+// Number of meioses between two individuals in the same male line
+// (found by walking up to the most recent common ancestor).
+int pipeline_meioses(Individual* a, Individual* b) {
+  int meioses = 0;
+
+  while (a != b) {
+    // move the youngest (smallest generation) up; a founder can never be younger
+    if (a->get_generation() <= b->get_generation() && a->get_father() != nullptr) {
+      a = a->get_father();
+    } else if (b->get_father() != nullptr) {
+      b = b->get_father();
+    } else {
+      return -1; // different male lines
+    }
+
+    meioses += 1;
+  }
+
+  return meioses;
+}
+
+// Founder of x's male line. The roots found are remembered for x and the ancestors walked through,
+// so finding the roots of many individuals walks each ancestor at most once.
+Individual* pipeline_root(Individual* x, std::unordered_map<Individual*, Individual*>& roots,
+                          std::vector<Individual*>& path) {
+  path.clear();
+  Individual* root = x;
+
+  while (root->get_father() != nullptr) {
+    auto got = roots.find(root);
+
+    if (got != roots.end()) {
+      root = got->second;
+      break;
+    }
+
+    path.push_back(root);
+    root = root->get_father();
+  }
+
+  for (auto indv : path) {
+    roots[indv] = root;
+  }
+
+  return root;
+}
+
+// Passes the founder's haplotype down his male line (depth first) without recursion:
+// Individual::pass_haplotype_to_children(true, ...) recurses once per generation,
+// and worker threads have small stacks.
+void pipeline_pass_haplotype_down(Individual* founder, std::vector<double>& mutation_rates, RNG* rng,
+                                  std::vector<Individual*>& stack) {
+  stack.clear();
+  stack.push_back(founder);
+
+  while (!stack.empty()) {
+    Individual* father = stack.back();
+    stack.pop_back();
+
+    father->pass_haplotype_to_children(false, mutation_rates, rng);
+
+    for (auto child : father->get_children()) {
+      stack.push_back(child);
+    }
+  }
+}
+
+// One replicate of the pipeline. Does not call R, so it can run in worker threads.
+void pipeline_replicate(size_t population_size,
+  int generations,
+  int extra_generations_full,
+  int individuals_generations_return,
+  bool enable_gamma_variance_extension,
+  double gamma_parameter_shape, double gamma_parameter_scale,
+  std::vector<double>& mutation_rates,
+  std::vector< std::vector<int> >& founder_haplotypes,
+  int sample_size,
+  RNG* rng,
+  PipelineReplicateResult& result) {
+
+  WFRandomFather wf_random_father(population_size, rng);
+  GammaVarianceRandomFather gamma_variance_father(population_size, gamma_parameter_shape, gamma_parameter_scale, rng);
+  SimulateChooseFather* choose_father = &wf_random_father;
+
+  if (enable_gamma_variance_extension) {
+    choose_father = &gamma_variance_father;
+  }
+
+  std::vector<Individual*> end_generation;
+  std::vector<Individual*> live_individuals;
+
+  Population* population = simulate_geneology_constant_size(population_size, generations,
+    extra_generations_full, individuals_generations_return, choose_father,
+    end_generation, live_individuals, &(result.generations), &(result.founders));
+
+  std::unordered_map<int, Individual*>* pop = population->get_population();
+  result.individuals = pop->size();
+  result.live_individuals = live_individuals.size();
+
+  // Haplotypes: founder haplotypes passed down each male line
+  std::vector<int> zero_haplotype(mutation_rates.size(), 0);
+  std::vector<Individual*> stack;
+
+  for (auto it = pop->begin(); it != pop->end(); ++it) {
+    Individual* founder = it->second;
+
+    if (founder->get_father() != nullptr) {
+      continue;
+    }
+
+    if (founder_haplotypes.size() > 0) {
+      int k = (int)(rng->unif_rand() * founder_haplotypes.size());
+      founder->set_haplotype(founder_haplotypes[k]);
+    } else {
+      founder->set_haplotype(zero_haplotype);
+    }
+
+    pipeline_pass_haplotype_down(founder, mutation_rates, rng, stack);
+  }
+
+  // Live individuals grouped by haplotype, with their founders (found once)
+  std::unordered_map< std::vector<int>, std::vector< std::pair<Individual*, Individual*> > > haplotype_groups;
+  std::unordered_map<Individual*, Individual*> roots;
+
+  for (auto indv : live_individuals) {
+    haplotype_groups[indv->get_haplotype()].push_back(std::make_pair(indv, pipeline_root(indv, roots, stack)));
+  }
+
+  result.live_haplotypes = haplotype_groups.size();
+
+  // Suspects: sample_size live individuals, without replacement (partial Fisher-Yates)
+  int n = std::min((size_t)sample_size, live_individuals.size());
+
+  for (int i = 0; i < n; ++i) {
+    int j = i + (int)(rng->unif_rand() * (live_individuals.size() - i));
+    std::swap(live_individuals[i], live_individuals[j]);
+
+    Individual* suspect = live_individuals[i];
+    Individual* suspect_root = pipeline_root(suspect, roots, stack); // remembered, so constant time
+    std::vector< std::pair<Individual*, Individual*> >& matches = haplotype_groups[suspect->get_haplotype()];
+    int matches_pedigree = 0;
+
+    for (auto& match_root : matches) {
+      Individual* match = match_root.first;
+
+      if (match == suspect || match_root.second != suspect_root) {
+        continue;
+      }
+
+      matches_pedigree += 1;
+
+      int m = pipeline_meioses(suspect, match);
+
+      if (m >= (int)result.meioses.size()) {
+        result.meioses.resize(m + 1, 0);
+      }
+
+      result.meioses[m] += 1;
+    }
+
+    result.suspect_pid.push_back(suspect->get_pid());
+    result.suspect_matches.push_back(matches.size() - 1);
+    result.suspect_matches_pedigree.push_back(matches_pedigree);
+  }
+
+  delete population;
+}
+
+//' Run the simulation pipeline
+//'
+//' Runs the full chain
+//' (simulate population, populate haplotypes, sample suspects and count matches)
+//' in C++ for a number of replicates and returns only the summary tables.
+//' No pedigree, population or individual R objects are created,
+//' and each population is discarded as soon as it is summarised.
+//'
+//' Replicates are run in parallel. As for [sample_geneology_replicates()],
+//' each replicate uses its own random number stream derived from `seed`,
+//' so results only depend on `seed` and not on the number of threads.
+//'
+//' Haplotypes are simulated as in [pedigrees_all_populate_haplotypes()]
+//' (or, if `founder_haplotypes` is given, with founders drawn uniformly
+//' from its rows as in [pedigrees_all_populate_haplotypes_custom_founders()]).
+//' Suspects are sampled uniformly without replacement among the live individuals
+//' (those in the last `generations_return` generations).
+//' For each suspect, the number of live individuals with a matching haplotype is counted
+//' in the entire population and in the suspect's pedigree, and for the latter the
+//' number of meioses to the suspect is tabulated.
+//'
+//' @param parameters Named list of parameters:
+//' `population_size`, `generations` and `mutation_rates` (required) and
+//' `generations_full`, `generations_return`, `enable_gamma_variance_extension`,
+//' `gamma_parameter_shape`, `gamma_parameter_scale` (as for [sample_geneology()]),
+//' `founder_haplotypes` (integer matrix, one founder haplotype per row; default all 0),
+//' `sample_size` (suspects per replicate; default 1),
+//' `replicates` (default 1), `seed`, `threads` and `progress`
+//' (as for [sample_geneology_replicates()]).
+//'
+//' @return A list with integer matrices
+//' `replicates` (one row per replicate: `generations`, `founders`, `individuals`,
+//' `live_individuals` and `live_haplotypes`, the number of distinct haplotypes among the live individuals),
+//' `suspects` (one row per suspect: `replicate`, `pid`, `matches` and `matches_pedigree`,
+//' the numbers of other live individuals with the suspect's haplotype in the population and in the pedigree) and
+//' `meioses` (columns `meioses` and `count`: the number of matches in the suspect's pedigree by meiotic distance,
+//' summed over suspects and replicates).
+//'
+//' @seealso [sample_geneology_replicates()].
+//'
+//' @export
+// [[Rcpp::export]]
+List run_pipeline(List parameters) {
+  CharacterVector parameter_names = parameters.names();
+
+  int parameters_count = parameter_names.size();
+
+  for (int i = 0; i < parameters_count; ++i) {
+    std::string name = Rcpp::as<std::string>(parameter_names[i]);
+
+    if (std::find(PIPELINE_PARAMETERS.begin(), PIPELINE_PARAMETERS.end(), name) == PIPELINE_PARAMETERS.end()) {
+      Rcpp::stop("Unknown parameter '" + name + "'");
+    }
+  }
+
+  int population_size = pipeline_parameter_required<int>(parameters, "population_size");
+  int generations = pipeline_parameter_required<int>(parameters, "generations");
+  std::vector<double> mutation_rates = pipeline_parameter_required< std::vector<double> >(parameters, "mutation_rates");
+  int generations_full = pipeline_parameter<int>(parameters, "generations_full", 1);
+  int generations_return = pipeline_parameter<int>(parameters, "generations_return", 3);
+  bool enable_gamma_variance_extension = pipeline_parameter<bool>(parameters, "enable_gamma_variance_extension", false);
+  double gamma_parameter_shape = pipeline_parameter<double>(parameters, "gamma_parameter_shape", 5.0);
+  double gamma_parameter_scale = pipeline_parameter<double>(parameters, "gamma_parameter_scale", 1.0/5.0);
+  int sample_size = pipeline_parameter<int>(parameters, "sample_size", 1);
+  int replicates = pipeline_parameter<int>(parameters, "replicates", 1);
+  int seed = pipeline_parameter<int>(parameters, "seed", NA_INTEGER);
+  int threads = pipeline_parameter<int>(parameters, "threads", 0);
+  bool progress = pipeline_parameter<bool>(parameters, "progress", true);
+
+  if (population_size < 1) {
+    Rcpp::stop("Please specify population_size >= 1");
+  }
+  if (generations < -1 || generations == 0) {
+    Rcpp::stop("Please specify generations as -1 (for simulation to 1 founder) or > 0");
+  }
+  if (generations_full <= 0) {
+    Rcpp::stop("generations_full must be at least 1");
+  }
+  if (generations_return <= 0) {
+    Rcpp::stop("generations_return must be at least 1");
+  }
+  if (enable_gamma_variance_extension) {
+    if (gamma_parameter_shape <= 0.0) {
+      Rcpp::stop("gamma_parameter_shape must be > 0.0");
+    }
+    if (gamma_parameter_scale <= 0.0) {
+      Rcpp::stop("gamma_parameter_scale must be > 0.0");
+    }
+  }
+  if (mutation_rates.size() == 0) {
+    Rcpp::stop("mutation_rates must have at least one locus");
+  }
+  if (sample_size < 0) {
+    Rcpp::stop("sample_size must be >= 0");
+  }
+  if (replicates < 1) {
+    Rcpp::stop("replicates must be at least 1");
+  }
+  if (threads < 0) {
+    Rcpp::stop("threads must be >= 0");
+  }
+
+  std::vector< std::vector<int> > founder_haplotypes;
+
+  if (parameters.containsElementNamed("founder_haplotypes")) {
+    IntegerMatrix founder_haplotypes_mat = parameters["founder_haplotypes"];
+
+    if ((size_t)founder_haplotypes_mat.ncol() != mutation_rates.size()) {
+      Rcpp::stop("founder_haplotypes must have a column per element in mutation_rates");
+    }
+    if (founder_haplotypes_mat.nrow() == 0) {
+      Rcpp::stop("founder_haplotypes must have at least one row");
+    }
+
+    for (int i = 0; i < founder_haplotypes_mat.nrow(); ++i) {
+      IntegerVector h = founder_haplotypes_mat(i, _);
+      founder_haplotypes.push_back(Rcpp::as< std::vector<int> >(h));
+    }
+  }
+
+  uint64_t base_seed = (seed == NA_INTEGER) ? draw_seed_from_R() : (uint64_t)seed;
+
+#ifdef _OPENMP
+  if (threads == 0) {
+    threads = omp_get_max_threads();
+  }
+#else
+  threads = 1;
+#endif
+
+  std::vector<PipelineReplicateResult> results(replicates);
+
+  Progress progress_bar(replicates, progress);
+  bool aborted = false;
+
+  #pragma omp parallel for schedule(dynamic, 1) num_threads(threads)
+  for (int r = 0; r < replicates; ++r) {
+    if (aborted) {
+      continue;
+    }
+
+    StreamRNG rng(base_seed, r);
+
+    pipeline_replicate(population_size, generations, generations_full - 1, generations_return - 1,
+      enable_gamma_variance_extension, gamma_parameter_shape, gamma_parameter_scale,
+      mutation_rates, founder_haplotypes, sample_size, &rng, results[r]);
+
+    // only master thread checks (and the progress bar is thread safe)
+    if (Progress::check_abort()) {
+      aborted = true;
+    }
+
+    if (progress) {
+      progress_bar.increment();
+    }
+  }
+
+  if (aborted) {
+    Rcpp::stop("Aborted");
+  }
+
+  // Summary tables (main thread only)
+  IntegerMatrix res_replicates(replicates, 5);
+  colnames(res_replicates) = CharacterVector::create("generations", "founders", "individuals", "live_individuals", "live_haplotypes");
+
+  size_t suspects = 0;
+  size_t max_meioses = 0;
+
+  for (int r = 0; r < replicates; ++r) {
+    res_replicates(r, 0) = results[r].generations;
+    res_replicates(r, 1) = results[r].founders;
+    res_replicates(r, 2) = results[r].individuals;
+    res_replicates(r, 3) = results[r].live_individuals;
+    res_replicates(r, 4) = results[r].live_haplotypes;
+
+    suspects += results[r].suspect_pid.size();
+    max_meioses = std::max(max_meioses, results[r].meioses.size());
+  }
+
+  IntegerMatrix res_suspects(suspects, 4);
+  colnames(res_suspects) = CharacterVector::create("replicate", "pid", "matches", "matches_pedigree");
+  size_t row = 0;
+
+  for (int r = 0; r < replicates; ++r) {
+    for (size_t i = 0; i < results[r].suspect_pid.size(); ++i) {
+      res_suspects(row, 0) = r + 1;
+      res_suspects(row, 1) = results[r].suspect_pid[i];
+      res_suspects(row, 2) = results[r].suspect_matches[i];
+      res_suspects(row, 3) = results[r].suspect_matches_pedigree[i];
+      row += 1;
+    }
+  }
+
+  std::vector<int> meioses_count(max_meioses, 0);
+
+  for (int r = 0; r < replicates; ++r) {
+    for (size_t m = 0; m < results[r].meioses.size(); ++m) {
+      meioses_count[m] += results[r].meioses[m];
+    }
+  }
+
+  // only meiotic distances that occurred
+  size_t meioses_rows = std::count_if(meioses_count.begin(), meioses_count.end(), [](int x) { return x > 0; });
+  IntegerMatrix res_meioses(meioses_rows, 2);
+  colnames(res_meioses) = CharacterVector::create("meioses", "count");
+  row = 0;
+
+  for (size_t m = 0; m < meioses_count.size(); ++m) {
+    if (meioses_count[m] > 0) {
+      res_meioses(row, 0) = m;
+      res_meioses(row, 1) = meioses_count[m];
+      row += 1;
+    }
+  }
+
+  List res;
+  res["replicates"] = res_replicates;
+  res["suspects"] = res_suspects;
+  res["meioses"] = res_meioses;
+
+  return res;
+}
+
@@ -0,0 +1,280 @@
+/**
+ api_query_server.cpp
+ Purpose: Logic to serve queries on pedigrees to other R sessions over a local socket.
+ Details: API between R user and C++ logic.
+
+ @author Mikkel Meyer Andersen
+ */
+
+#include <RcppArmadillo.h>
+
+// [[Rcpp::depends(RcppProgress)]]
+// [[Rcpp::depends(RcppArmadillo)]]
+
+#include <progress.hpp>
+
+#include <thread>
+
+#include "malan_types.h"
+
+using namespace Rcpp;
+
+// how often the server checks for user interrupts (and workers for stop), in milliseconds
+#define QUERY_POLL_MS 200
+
+static bool query_server_check_abort() {
+  return Progress::check_abort();
+}
+
+/*
+Send a request to the server on socket_path, and stop with an error message
+unless the status is QUERY_STATUS_OK.
+*/
+static std::vector<int32_t> query_server_request(const std::string& socket_path, int type, int count,
+                                                 const std::vector<int32_t>& queries) {
+  std::vector<int32_t> response;
+  int status = QUERY_STATUS_OK;
+
+  try {
+    QueryClient client(socket_path);
+    status = client.request(type, count, queries, response);
+  } catch (std::exception& e) {
+    Rcpp::stop(e.what());
+  }
+
+  if (status == QUERY_STATUS_UNKNOWN_PID) {
+    Rcpp::stop("Unknown pid (not in the pedigrees served)");
+  } else if (status == QUERY_STATUS_RESPONSE_TOO_LARGE) {
+    Rcpp::stop("The response is too large; please split the queries into smaller batches");
+  } else if (status != QUERY_STATUS_OK) {
+    Rcpp::stop("The server could not answer the request");
+  }
+
+  return response;
+}
+
+//' Serve queries on pedigrees over a local socket
+//'
+//' Holds the pedigrees (with haplotypes) in memory and answers queries from other R sessions
+//' (see [query_server_info()], [query_match_counts()], [query_relatives()] and [query_distances()])
+//' over the Unix domain socket `socket_path`, until [query_server_shutdown()] is called
+//' or the user interrupts.
+//' This blocks the R session, so the server is typically run by `Rscript`, e.g. after
+//' simulating a population, building pedigrees and populating haplotypes.
+//'
+//' The pedigrees are copied into a flat, read-only index once, and requests (a request is a batch of queries)
+//' are answered concurrently by `threads` worker threads; connections waiting between requests
+//' do not hold a worker.
+//' Requests and responses are compact: 32-bit integers in the byte order of the machine.
+//'
+//' Not supported on Windows.
+//'
+//' @param pedigrees Pedigree list with haplotypes populated
+//' @param socket_path Path of the socket (e.g. from [tempfile()]); a socket left there by a server no longer running is replaced
+//' @param generation_upper_bound_in_result Count matches in generation 0, 1, ..., generation_upper_bound_in_result.
+//' -1 means disabled, consider all generations.
+//' @param threads Number of worker threads (requests answered concurrently); 0 means the number of cores.
+//'
+//' @seealso [query_server_info()].
+//'
+//' @export
+// [[Rcpp::export]]
+void query_server_run(Rcpp::XPtr< std::vector<Pedigree*> > pedigrees,
+                      std::string socket_path,
+                      int generation_upper_bound_in_result = -1,
+                      int threads = 0) {
+
+  if (generation_upper_bound_in_result < -1) {
+    Rcpp::stop("generation_upper_bound_in_result must be -1 or >= 0");
+  }
+
+  if (threads < 0) {
+    Rcpp::stop("threads must be >= 0");
+  }
+
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  Progress progress_bar(0, false);
+
+  try {
+    QueryEngine engine(*pedigrees, generation_upper_bound_in_result);
+    QueryServer server(engine, socket_path);
+    server.run(threads, &query_server_check_abort, QUERY_POLL_MS);
+  } catch (std::exception& e) {
+    Rcpp::stop(e.what());
+  }
+}
+
+//' Information from a query server
+//'
+//' @param socket_path Path of the socket of a server started by [query_server_run()]
+//'
+//' @return Vector with `loci` and `individuals` (the number of individuals in the generations used for match counts)
+//'
+//' @seealso [query_server_run()].
+//'
+//' @export
+// [[Rcpp::export]]
+IntegerVector query_server_info(std::string socket_path) {
+  std::vector<int32_t> response = query_server_request(socket_path, QUERY_INFO, 0, std::vector<int32_t>());
+
+  IntegerVector res = IntegerVector::create(response[0], response[1]);
+  res.attr("names") = CharacterVector::create("loci", "individuals");
+
+  return res;
+}
+
+//' Count haplotype matches on a query server
+//'
+//' For each haplotype, the number of individuals served by [query_server_run()]
+//' (in its generations used for match counts) with that haplotype,
+//' as [count_haplotype_occurrences_individuals()]. All haplotypes are sent in one request.
+//'
+//' @param socket_path Path of the socket of a server started by [query_server_run()]
+//' @param haplotypes Integer matrix with a haplotype per row
+//'
+//' @return Vector with the number of matches for each haplotype
+//'
+//' @seealso [query_server_run()].
+//'
+//' @export
+// [[Rcpp::export]]
+IntegerVector query_match_counts(std::string socket_path, IntegerMatrix haplotypes) {
+  size_t n = haplotypes.nrow();
+  size_t loci = haplotypes.ncol();
+  std::vector<int32_t> queries(n * loci);
+
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t loc = 0; loc < loci; ++loc) {
+      queries[i*loci + loc] = haplotypes(i, loc);
+    }
+  }
+
+  IntegerVector info = query_server_info(socket_path);
+
+  if ((size_t)info[0] != loci) {
+    Rcpp::stop("haplotypes must have as many columns as the server has loci");
+  }
+
+  std::vector<int32_t> response = query_server_request(socket_path, QUERY_MATCH_COUNTS, n, queries);
+
+  return Rcpp::wrap(response);
+}
+
+//' Search for relatives on a query server
+//'
+//' For each pid, finds the individuals in his pedigree with a haplotype at most `max_L1` from his
+//' (L1 distance, sum of absolute differences over loci), e.g. `max_L1 = 0` for matches,
+//' with their meiotic distance to him.
+//' All pids are sent in one request.
+//'
+//' @param socket_path Path of the socket of a server started by [query_server_run()]
+//' @param pids Vector of pids
+//' @param max_L1 Largest L1 distance (recycled)
+//'
+//' @return A data frame with a row per relative found: `query_pid`, `pid`, `meioses` and `L1`
+//'
+//' @seealso [query_server_run()] and [pedigree_haplotype_matches_in_pedigree_meiosis_L1_dists()].
+//'
+//' @export
+// [[Rcpp::export]]
+DataFrame query_relatives(std::string socket_path, IntegerVector pids, IntegerVector max_L1 = IntegerVector::create(0)) {
+  size_t n = pids.size();
+
+  if (max_L1.size() == 0 && n > 0) {
+    Rcpp::stop("max_L1 must have at least one element");
+  }
+
+  std::vector<int32_t> queries(2*n);
+
+  for (size_t i = 0; i < n; ++i) {
+    queries[2*i] = pids[i];
+    queries[2*i + 1] = max_L1[i % max_L1.size()];
+  }
+
+  std::vector<int32_t> response = query_server_request(socket_path, QUERY_RELATIVES, n, queries);
+
+  std::vector<int> res_query_pid;
+  std::vector<int> res_pid;
+  std::vector<int> res_meioses;
+  std::vector<int> res_L1;
+  size_t k = 0;
+
+  for (size_t i = 0; i < n; ++i) {
+    int m = response[k++];
+
+    for (int r = 0; r < m; ++r) {
+      res_query_pid.push_back(pids[i]);
+      res_pid.push_back(response[k++]);
+      res_meioses.push_back(response[k++]);
+      res_L1.push_back(response[k++]);
+    }
+  }
+
+  return DataFrame::create(
+    Named("query_pid") = res_query_pid,
+    Named("pid") = res_pid,
+    Named("meioses") = res_meioses,
+    Named("L1") = res_L1);
+}
+
+//' Distances between pairs of individuals on a query server
+//'
+//' For each pair `pids_1[i]`, `pids_2[i]`, the meiotic distance (`NA` if they are not in the same pedigree)
+//' and the L1 distance between their haplotypes. All pairs are sent in one request.
+//'
+//' @param socket_path Path of the socket of a server started by [query_server_run()]
+//' @param pids_1 Vector of pids
+//' @param pids_2 Vector of pids (same length as `pids_1`)
+//'
+//' @return A data frame with `meioses` and `L1`, a row per pair
+//'
+//' @seealso [query_server_run()].
+//'
+//' @export
+// [[Rcpp::export]]
+DataFrame query_distances(std::string socket_path, IntegerVector pids_1, IntegerVector pids_2) {
+  size_t n = pids_1.size();
+
+  if (pids_2.size() != n) {
+    Rcpp::stop("pids_1 and pids_2 must have the same length");
+  }
+
+  std::vector<int32_t> queries(2*n);
+
+  for (size_t i = 0; i < n; ++i) {
+    queries[2*i] = pids_1[i];
+    queries[2*i + 1] = pids_2[i];
+  }
+
+  std::vector<int32_t> response = query_server_request(socket_path, QUERY_DISTANCES, n, queries);
+
+  IntegerVector res_meioses(n);
+  IntegerVector res_L1(n);
+
+  for (size_t i = 0; i < n; ++i) {
+    res_meioses[i] = (response[2*i] == -1) ? NA_INTEGER : response[2*i];
+    res_L1[i] = response[2*i + 1];
+  }
+
+  return DataFrame::create(
+    Named("meioses") = res_meioses,
+    Named("L1") = res_L1);
+}
+
+//' Stop a query server
+//'
+//' The server stops accepting connections, finishes the requests being answered and returns.
+//'
+//' @param socket_path Path of the socket of a server started by [query_server_run()]
+//'
+//' @seealso [query_server_run()].
+//'
+//' @export
+// [[Rcpp::export]]
+void query_server_shutdown(std::string socket_path) {
+  query_server_request(socket_path, QUERY_SHUTDOWN, 0, std::vector<int32_t>());
+}
+
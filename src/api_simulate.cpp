@@ -59,6 +59,8 @@ using namespace Rcpp;
 //' @param gamma_parameter_scale Parameter realted to symmetric Dirichlet distribution for each man's probability to be father. Refer to details.
 //' @param progress Show progress.
 //' @param verbose_result Verbose result.
+//' @param diagnostics Return per generation diagnostics (see below); 
+//' a lightweight alternative to `verbose_result`.
 //' 
 //' @return A malan_simulation / list with the following entries:
 //' \itemize{
@@ -70,14 +72,23 @@ using namespace Rcpp;
 //'   \item `end_generation_individuals`. Pointers to individuals in end generation.
 //'   \item `individuals_generations`. Pointers to individuals in last `generations_return` generation (if `generations_return = 3`, then individuals in the last three generations are returned).
 //' }
+//' If `enable_gamma_variance_extension` is true, then `gamma_parameter_shape` and `gamma_parameter_scale` are also returned (used by [extend_geneology()]).
 //' If `verbose_result` is true, then these additional components are also returned:
 //' \itemize{
 //'   \item `individual_pids`. A matrix with pid (person id) for each individual.
 //'   \item `father_pids`. A matrix with pid (person id) for each individual's father.
 //'   \item `father_indices`. A matrix with indices for fathers.
 //' }
+//' If `diagnostics` is true, then `diagnostics` is also returned: a data frame with a row per 
+//' simulated generation (1 is the fathers of the end generation) with 
+//' the number of individuals in the previous generation with descendants in the end generation (`lineages`), 
+//' the number of distinct fathers of these (`fathers`), 
+//' the number of individuals in the generation (`founders`, including those created due to `generations_full`), 
+//' the largest number of children of a father (`max_children`) and 
+//' the variance of the number of children over all `population_size` men (`offspring_var`, counting 
+//' only children with descendants).
 //' 
-//' @seealso [sample_geneology_varying_size()].
+//' @seealso [sample_geneology_varying_size()] and [extend_geneology()].
 //' 
 //' @import Rcpp
 //' @import RcppProgress
@@ -91,7 +102,8 @@ List sample_geneology(size_t population_size,
   bool enable_gamma_variance_extension = false,
   double gamma_parameter_shape = 5.0, double gamma_parameter_scale = 1.0/5.0, 
   bool progress = true, 
-  bool verbose_result = false) {
+  bool verbose_result = false,
+  bool diagnostics = false) {
   
   if (generations_full <= 0) {
     Rcpp::stop("generations_full must be at least 1");
@@ -123,8 +135,10 @@ List sample_geneology(size_t population_size,
     }
   }
 
-  WFRandomFather wf_random_father(population_size);
-  GammaVarianceRandomFather gamma_variance_father(population_size, gamma_parameter_shape, gamma_parameter_scale);  
+  // uniforms for the fathers are drawn in bulk, see set_rng_compatibility()
+  BufferedRNG rng;
+  WFRandomFather wf_random_father(population_size, &rng);
+  GammaVarianceRandomFather gamma_variance_father(population_size, gamma_parameter_shape, gamma_parameter_scale, &rng);  
   SimulateChooseFather* choose_father = &wf_random_father;
   
   if (enable_gamma_variance_extension) {
@@ -219,9 +233,59 @@ List sample_geneology(size_t population_size,
   
   int founders_left = population_size;
   
+  // diagnostics are computed online from the father indices of a generation
+  SummaryGenerationSink diagnostics_sink;
+  std::vector<int> diagnostics_fathers;
+  std::vector<int> diagnostics_founders;
+  
+  if (diagnostics) {
+    diagnostics_fathers.resize(population_size);
+  }
+  
+  // sparse path for standard Wright-Fisher with few lineages, see simulate_generation_sparse()
+  bool sparse = false;
+  std::vector< std::pair<int, Individual*> > lineages;
+  std::unordered_map<int, Individual*> drawn_fathers;
+  std::vector<Individual*> new_fathers;
+  
   // now, find out who the fathers to the children are
   size_t generation = 1;
   while ((simulate_fixed_number_generations == true && generation < generations) || (simulate_fixed_number_generations == false && founders_left > 1)) {
+    if (!sparse && !verbose_result && !diagnostics && choose_father->is_uniform() && 
+        generation > extra_generations_full && (size_t)founders_left * SPARSE_LINEAGES_FRACTION < population_size) {
+      sparse = true;
+      lineages_from_generation(children_generation, lineages);
+    }
+    
+    if (sparse) {
+      choose_father->update_state_new_generation();
+      rng.reserve(founders_left); // one uniform per child with children
+      
+      simulate_generation_sparse(lineages, choose_father, generation, &individual_id, drawn_fathers, new_fathers);
+      
+      for (auto father : new_fathers) {
+        (*population_map)[father->get_pid()] = father;
+        
+        if (generation <= individuals_generations_return) {
+          Rcpp::XPtr<Individual> father_xptr(father, RCPP_XPTR_2ND_ARG);
+          last_k_generations_individuals.push_back(father_xptr);
+        }
+      }
+      
+      founders_left = lineages.size();
+      
+      if (Progress::check_abort()) {
+        stop("Aborted");
+      }
+      
+      if (progress) {
+        progress_bar.increment();
+      }
+      
+      generation += 1;
+      continue;
+    }
+    
     int new_founders_left = 0;
     //Rcpp::Rcerr << "Generation " << generation << std::endl;
     
@@ -241,7 +305,12 @@ List sample_geneology(size_t population_size,
       std::fill(father_indices_tmp_vec.begin(), father_indices_tmp_vec.end(), NA_INTEGER);
     }
     
+    if (diagnostics) {
+      std::fill(diagnostics_fathers.begin(), diagnostics_fathers.end(), -1);
+    }
+    
     choose_father->update_state_new_generation();
+    rng.reserve(founders_left); // one uniform per child with children
     
     // now, run through children to pick each child's father
     for (size_t i = 0; i < population_size; ++i) {
@@ -268,6 +337,10 @@ List sample_geneology(size_t population_size,
         father_pids_tmp_vec[i] = fathers_generation[father_i]->get_pid();
         father_indices_tmp_vec[i] = father_i + 1; // 1 to get R's 1-indexed
       }      
+      
+      if (diagnostics) {
+        diagnostics_fathers[i] = father_i;
+      }
             
       fathers_generation[father_i]->add_child(children_generation[i]);
     }
@@ -286,6 +359,11 @@ List sample_geneology(size_t population_size,
       }      
     }
     
+    if (diagnostics) {
+      diagnostics_sink.consume(generation, diagnostics_fathers);
+      diagnostics_founders.push_back(new_founders_left);
+    }
+    
     if (verbose_result) {
       if (simulate_fixed_number_generations) {
         individual_pids(Rcpp::_, generation) = individual_pids_tmp_vec;
@@ -354,12 +432,27 @@ List sample_geneology(size_t population_size,
   res["end_generation_individuals"] = end_generation_individuals;
   res["individuals_generations"] = last_k_generations_individuals;
 
+  if (enable_gamma_variance_extension) {
+    res["gamma_parameter_shape"] = gamma_parameter_shape;
+    res["gamma_parameter_scale"] = gamma_parameter_scale;
+  }
+
   if (verbose_result) {
     res["individual_pids"] = individual_pids;
     res["father_pids"] = father_pids;
     res["father_indices"] = father_indices;
   }
   
+  if (diagnostics) {
+    res["diagnostics"] = DataFrame::create(
+      Named("generation") = diagnostics_sink.get_generation(),
+      Named("lineages") = diagnostics_sink.get_children(),
+      Named("fathers") = diagnostics_sink.get_fathers(),
+      Named("founders") = diagnostics_founders,
+      Named("max_children") = diagnostics_sink.get_max_children(),
+      Named("offspring_var") = diagnostics_sink.get_offspring_var());
+  }
+  
   res.attr("class") = CharacterVector::create("malan_simulation", "list");
   
   return res;
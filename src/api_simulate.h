@@ -15,8 +15,15 @@
 
 #include "malan_types.h"
 
+#include <unordered_map>
+#include <utility>
+
 using namespace Rcpp;
 
+// Use the sparse (occupancy) path for standard Wright-Fisher when 
+// lineages * SPARSE_LINEAGES_FRACTION < population size
+#define SPARSE_LINEAGES_FRACTION 16
+
 void create_father_update_simulation_state(
   int father_i, 
   int* individual_id, 
@@ -38,3 +45,50 @@ void create_father_update_simulation_state_varying_size(
   std::unordered_map<int, Individual*>* population_map, 
   int* new_founders_left,
   List& last_k_generations_individuals);
+
+Population* simulate_geneology_constant_size(
+  size_t population_size, 
+  int generations,
+  int extra_generations_full,
+  int individuals_generations_return,
+  SimulateChooseFather* choose_father,
+  std::vector<Individual*>& end_generation,
+  std::vector<Individual*>& last_k_generations,
+  int* generations_simulated,
+  int* founders_left);
+
+void lineages_from_generation(
+  const std::vector<Individual*>& generation_individuals,
+  std::vector< std::pair<int, Individual*> >& lineages);
+
+void simulate_generation_sparse(
+  std::vector< std::pair<int, Individual*> >& lineages,
+  SimulateChooseFather* choose_father,
+  int generation,
+  int* individual_id,
+  std::unordered_map<int, Individual*>& drawn_fathers,
+  std::vector<Individual*>& new_fathers);
+
+// exported in api_simulate.cpp
+List sample_geneology(size_t population_size, 
+  int generations,
+  int generations_full,
+  int generations_return,
+  bool enable_gamma_variance_extension,
+  double gamma_parameter_shape, 
+  double gamma_parameter_scale, 
+  bool progress, 
+  bool verbose_result,
+  bool diagnostics);
+
+int continue_geneology_constant_size(
+  std::unordered_map<int, Individual*>* population_map,
+  std::vector<Individual*>& children_generation,
+  int first_generation,
+  int generations_end,
+  int extra_generations_full,
+  int individuals_generations_return,
+  SimulateChooseFather* choose_father,
+  std::vector<Individual*>& last_k_generations,
+  int* individual_id,
+  int* founders_left);
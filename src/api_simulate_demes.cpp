@@ -0,0 +1,309 @@
+/**
+ api_simulate_demes.cpp
+ Purpose: Logic to simulate a structured population (demes with migration).
+ Details: API between R user and C++ logic.
+
+ @author Mikkel Meyer Andersen
+ */
+
+#include <RcppArmadillo.h>
+
+// [[Rcpp::depends(RcppProgress)]]
+// [[Rcpp::depends(RcppArmadillo)]]
+
+#include <progress.hpp>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "malan_types.h"
+
+using namespace Rcpp;
+
+//' Simulate a geneology with demes and migration
+//'
+//' This function simulates a geneology in a structured population
+//' consisting of D demes of constant sizes.
+//' As in [sample_geneology()], the simulation is backwards in time:
+//' a child in deme `i` has his father drawn from deme `j`
+//' with probability `migration_matrix[i, j]`, and then uniformly
+//' amongst the men in deme `j` in the previous generation
+//' (i.e. standard Wright-Fisher within each deme).
+//' With one deme this is the same model as [sample_geneology()].
+//'
+//' Within each generation, fathers for the children in the different demes
+//' are drawn in parallel. Each deme uses its own random number stream derived from `seed`,
+//' so the result only depends on `seed` and not on the number of threads.
+//' If `seed` is `NA`, it is drawn from R's random number generator,
+//' hence `set.seed()` can be used for reproducibility.
+//'
+//' The deme of an individual is available by [get_deme()] and [get_deme_from_pid()],
+//' e.g. for use with [estimate_theta_subpops_pids()].
+//'
+//' @param population_sizes Size of each deme (the length is the number of demes, D)
+//' @param migration_matrix D x D matrix; row `i` is the distribution of the father's deme for a child in deme `i`
+//' @param generations Number of generations to simulate (>= 1)
+//' @param generations_full Number of full generations to keep track of (all individuals are created in these)
+//' @param generations_return Number of generations to return individuals from
+//' @param seed Seed for the random number streams; `NA` means draw from R's random number generator.
+//' @param threads Number of threads; 0 means the OpenMP default.
+//' @param progress Show progress
+//'
+//' @return A malan_simulation object as returned by [sample_geneology()]
+//' (without the verbose components), with the additional element `demes` (the number of demes).
+//'
+//' @seealso [sample_geneology()] and [estimate_theta_subpops_pids()].
+//'
+//' @export
+// [[Rcpp::export]]
+List sample_geneology_demes(IntegerVector population_sizes,
+                            NumericMatrix migration_matrix,
+                            int generations,
+                            int generations_full = 1,
+                            int generations_return = 3,
+                            int seed = NA_INTEGER,
+                            int threads = 0,
+                            bool progress = true) {
+
+  int D = population_sizes.size();
+
+  if (D < 1) {
+    Rcpp::stop("Please specify at least one deme");
+  }
+
+  for (int i = 0; i < D; ++i) {
+    if (population_sizes[i] < 1) {
+      Rcpp::stop("Please specify population_sizes >= 1");
+    }
+  }
+
+  if (migration_matrix.nrow() != D || migration_matrix.ncol() != D) {
+    Rcpp::stop("migration_matrix must be a D x D matrix where D is the length of population_sizes");
+  }
+
+  // cumulative distributions of the father's deme
+  std::vector< std::vector<double> > migration_cumdist(D, std::vector<double>(D));
+
+  for (int i = 0; i < D; ++i) {
+    double cumsum = 0.0;
+
+    for (int j = 0; j < D; ++j) {
+      if (migration_matrix(i, j) < 0.0) {
+        Rcpp::stop("migration_matrix must be non-negative");
+      }
+
+      cumsum += migration_matrix(i, j);
+      migration_cumdist[i][j] = cumsum;
+    }
+
+    if (fabs(cumsum - 1.0) > 1e-8) {
+      Rcpp::stop("Each row in migration_matrix must sum to 1");
+    }
+
+    // renormalise by the row sum so that the last entry is exactly 1
+    // (and demes with probability 0 are never drawn)
+    for (int j = 0; j < D; ++j) {
+      migration_cumdist[i][j] /= cumsum;
+    }
+  }
+
+  if (generations < 1) {
+    Rcpp::stop("Please specify generations >= 1");
+  }
+
+  if (generations_full <= 0) {
+    Rcpp::stop("generations_full must be at least 1");
+  }
+  int extra_generations_full = generations_full - 1;
+
+  if (generations_return <= 0) {
+    Rcpp::stop("generations_return must be at least 1");
+  }
+  int individuals_generations_return = generations_return - 1;
+
+  if (threads < 0) {
+    Rcpp::stop("threads must be >= 0");
+  }
+
+  uint64_t base_seed = (seed == NA_INTEGER) ? draw_seed_from_R() : (uint64_t)seed;
+
+#ifdef _OPENMP
+  if (threads == 0) {
+    threads = omp_get_max_threads();
+  }
+#else
+  threads = 1;
+#endif
+
+  std::vector<StreamRNG> rngs;
+  for (int i = 0; i < D; ++i) {
+    rngs.push_back(StreamRNG(base_seed, i));
+  }
+
+  std::unordered_map<int, Individual*>* population_map = new std::unordered_map<int, Individual*>(); // pid's are garanteed to be unique
+  Population* population = new Population(population_map);
+  Rcpp::XPtr<Population> population_xptr(population, RCPP_XPTR_2ND_ARG_CLEANER);
+  population_xptr.attr("class") = CharacterVector::create("malan_population", "externalptr");
+
+  List end_generation_individuals;
+  List last_k_generations_individuals;
+
+  int individual_id = 1;
+  std::vector< std::vector<Individual*> > children_generation(D);
+  std::vector< std::vector<Individual*> > fathers_generation(D);
+
+  for (int i = 0; i < D; ++i) {
+    children_generation[i].resize(population_sizes[i]);
+    fathers_generation[i].resize(population_sizes[i]);
+
+    for (int c = 0; c < population_sizes[i]; ++c) {
+      Individual* indv = new Individual(individual_id++, 0);
+      indv->set_deme(i);
+      children_generation[i][c] = indv;
+      (*population_map)[indv->get_pid()] = indv;
+
+      Rcpp::XPtr<Individual> indv_xptr(indv, RCPP_XPTR_2ND_ARG);
+      end_generation_individuals.push_back(indv_xptr);
+
+      if (individuals_generations_return >= 0) {
+        last_k_generations_individuals.push_back(indv_xptr);
+      }
+    }
+  }
+
+  // children_father[i][c]: index (in father deme) of father of child c in deme i
+  std::vector< std::vector<int> > children_father(D);
+  // children_by_father_deme[i][j]: children in deme i with father in deme j
+  std::vector< std::vector< std::vector<int> > > children_by_father_deme(D, std::vector< std::vector<int> >(D));
+  std::vector< std::vector<char> > father_used(D);
+  std::vector<int> fathers_count(D);
+  std::vector<int> fathers_first_pid(D);
+
+  for (int i = 0; i < D; ++i) {
+    children_father[i].resize(population_sizes[i]);
+    father_used[i].resize(population_sizes[i]);
+  }
+
+  int founders_left = individual_id - 1;
+
+  Progress progress_bar(generations, progress);
+
+  int generation = 1;
+  while (generation < generations) {
+    bool full_generation = (generation <= extra_generations_full);
+
+    // Draw fathers, in parallel over the children's demes
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(threads)
+    for (int i = 0; i < D; ++i) {
+      for (int j = 0; j < D; ++j) {
+        children_by_father_deme[i][j].clear();
+      }
+
+      for (int c = 0; c < population_sizes[i]; ++c) {
+        // if a child did not have children himself, forget his ancestors
+        if (children_generation[i][c] == nullptr) {
+          continue;
+        }
+
+        double u = rngs[i].unif_rand();
+        int j = 0;
+        while (u >= migration_cumdist[i][j]) {
+          j += 1;
+        }
+
+        int father_i = (int)(rngs[i].unif_rand() * population_sizes[j]);
+        children_father[i][c] = father_i;
+        children_by_father_deme[i][j].push_back(c);
+      }
+    }
+
+    // Find the fathers needed, in parallel over the fathers' demes
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(threads)
+    for (int j = 0; j < D; ++j) {
+      std::fill(father_used[j].begin(), father_used[j].end(), full_generation ? 1 : 0);
+
+      for (int i = 0; i < D; ++i) {
+        for (auto c : children_by_father_deme[i][j]) {
+          father_used[j][children_father[i][c]] = 1;
+        }
+      }
+
+      fathers_count[j] = std::count(father_used[j].begin(), father_used[j].end(), 1);
+    }
+
+    // pids are given deme by deme, so they do not depend on the number of threads
+    for (int j = 0; j < D; ++j) {
+      fathers_first_pid[j] = individual_id;
+      individual_id += fathers_count[j];
+    }
+
+    // Create fathers and add children, in parallel over the fathers' demes
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(threads)
+    for (int j = 0; j < D; ++j) {
+      int pid = fathers_first_pid[j];
+
+      for (int k = 0; k < population_sizes[j]; ++k) {
+        fathers_generation[j][k] = nullptr;
+
+        if (father_used[j][k]) {
+          Individual* father = new Individual(pid++, generation);
+          father->set_deme(j);
+          fathers_generation[j][k] = father;
+        }
+      }
+
+      for (int i = 0; i < D; ++i) {
+        for (auto c : children_by_father_deme[i][j]) {
+          fathers_generation[j][children_father[i][c]]->add_child(children_generation[i][c]);
+        }
+      }
+    }
+
+    // Register fathers (main thread)
+    founders_left = 0;
+
+    for (int j = 0; j < D; ++j) {
+      for (auto father : fathers_generation[j]) {
+        if (father == nullptr) {
+          continue;
+        }
+
+        (*population_map)[father->get_pid()] = father;
+        founders_left += 1;
+
+        if (generation <= individuals_generations_return) {
+          Rcpp::XPtr<Individual> father_xptr(father, RCPP_XPTR_2ND_ARG);
+          last_k_generations_individuals.push_back(father_xptr);
+        }
+      }
+    }
+
+    children_generation.swap(fathers_generation);
+
+    if (Progress::check_abort()) {
+      stop("Aborted");
+    }
+
+    if (progress) {
+      progress_bar.increment();
+    }
+
+    generation += 1;
+  }
+
+  List res;
+  res["population"] = population_xptr;
+  res["generations"] = generation;
+  res["founders"] = founders_left;
+  res["growth_type"] = "ConstantPopulationSize";
+  res["sdo_type"] = "StandardWF";
+  res["demes"] = D;
+  res["end_generation_individuals"] = end_generation_individuals;
+  res["individuals_generations"] = last_k_generations_individuals;
+
+  res.attr("class") = CharacterVector::create("malan_simulation", "list");
+
+  return res;
+}
+
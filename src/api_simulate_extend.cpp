@@ -0,0 +1,212 @@
+/**
+ api_simulate_extend.cpp
+ Purpose: Logic to extend a simulated population with more ancestral generations.
+ Details: API between R user and C++ logic.
+
+ @author Mikkel Meyer Andersen
+ */
+
+#include <RcppArmadillo.h>
+
+// [[Rcpp::depends(RcppProgress)]]
+// [[Rcpp::depends(RcppArmadillo)]]
+
+#include <progress.hpp>
+
+#include "malan_types.h"
+#include "api_simulate.h"
+
+using namespace Rcpp;
+
+//' Extend a geneology with additional ancestral generations
+//'
+//' Continues the backwards simulation of a population simulated by
+//' [sample_geneology()] (or [sample_geneology_replicates()]) from its
+//' oldest generation, using the same model (population size and
+//' standard Wright-Fisher or gamma variation in the number of offspring).
+//' The new ancestors are added to the existing population (nothing is copied),
+//' so a long simulation can be done incrementally, e.g.
+//' `sim <- sample_geneology(1e3, 50); sim <- extend_geneology(sim, 50)`
+//' is the same model as `sample_geneology(1e3, 100)`.
+//'
+//' Adding ancestors can merge pedigrees, so pedigrees built by [build_pedigrees()]
+//' are no longer valid: if pedigrees have been built for the population,
+//' they must be given as `pedigrees`, and they are then removed
+//' (`pedigrees` becomes an empty pedigree list; call [build_pedigrees()] again).
+//' Haplotypes are removed as well, and must be populated again.
+//'
+//' R's random number generator is used, so `set.seed()` can be used for reproducibility.
+//' If interrupted, the generations simulated so far are kept (and returned).
+//'
+//' @param simulation A malan_simulation object as returned by [sample_geneology()]
+//' @param generations Number of additional generations to simulate; -1 for simulation to 1 founder
+//' @param pedigrees Pedigree list built for the population (if any)
+//' @param progress Show progress.
+//'
+//' @return A malan_simulation object: `simulation` with `generations` and `founders` updated
+//' (the population is the same, now with the new ancestors).
+//'
+//' @seealso [sample_geneology()].
+//'
+//' @export
+// [[Rcpp::export]]
+List extend_geneology(List simulation,
+                      int generations,
+                      Rcpp::Nullable< Rcpp::XPtr< std::vector<Pedigree*> > > pedigrees = R_NilValue,
+                      bool progress = true) {
+
+  if (!simulation.inherits("malan_simulation")) {
+    Rcpp::stop("simulation must be a malan_simulation object");
+  }
+
+  std::string growth_type = Rcpp::as<std::string>(simulation["growth_type"]);
+  std::string sdo_type = Rcpp::as<std::string>(simulation["sdo_type"]);
+
+  if (growth_type != "ConstantPopulationSize") {
+    Rcpp::stop("Only simulations with constant population size can be extended");
+  }
+
+  if (simulation.containsElementNamed("demes") && Rcpp::as<int>(simulation["demes"]) != 1) {
+    Rcpp::stop("Simulations with more than one deme cannot be extended");
+  }
+
+  if (simulation.containsElementNamed("sample_size")) {
+    Rcpp::stop("Simulations of a sample cannot be extended");
+  }
+  
+  if (simulation.containsElementNamed("coalescent")) {
+    Rcpp::stop("Hybrid simulations cannot be extended");
+  }
+
+  if (generations < -1 || generations == 0) {
+    Rcpp::stop("Please specify generations as -1 (for simulation to 1 founder) or > 0");
+  }
+
+  Rcpp::XPtr<Population> population = simulation["population"];
+  std::unordered_map<int, Individual*>* population_map = population->get_population();
+  size_t population_size = Rcpp::as<List>(simulation["end_generation_individuals"]).size();
+  int generations_simulated = Rcpp::as<int>(simulation["generations"]);
+  int founders_left = Rcpp::as<int>(simulation["founders"]);
+
+  double gamma_parameter_shape = 5.0;
+  double gamma_parameter_scale = 1.0/5.0;
+
+  if (sdo_type == "GammaVariation") {
+    if (!simulation.containsElementNamed("gamma_parameter_shape") || !simulation.containsElementNamed("gamma_parameter_scale")) {
+      Rcpp::stop("The gamma parameters are not in simulation; please simulate again with this version of the package");
+    }
+
+    gamma_parameter_shape = Rcpp::as<double>(simulation["gamma_parameter_shape"]);
+    gamma_parameter_scale = Rcpp::as<double>(simulation["gamma_parameter_scale"]);
+  } else if (sdo_type != "StandardWF") {
+    Rcpp::stop("Unknown sdo_type");
+  }
+
+  // Pedigrees are invalidated
+  bool pedigrees_built = false;
+
+  for (auto it = population_map->begin(); it != population_map->end(); ++it) {
+    if (it->second->pedigree_is_set()) {
+      pedigrees_built = true;
+      break;
+    }
+  }
+
+  if (pedigrees_built) {
+    if (pedigrees.isNull()) {
+      Rcpp::stop("Pedigrees have been built for this population, please give them as pedigrees so they can be removed");
+    }
+
+    Rcpp::XPtr< std::vector<Pedigree*> > peds = Rcpp::as< Rcpp::XPtr< std::vector<Pedigree*> > >(pedigrees.get());
+    size_t pedigrees_individuals = 0;
+
+    for (auto ped : *peds) {
+      Individual* root = ped->get_root();
+      auto got = population_map->find(root->get_pid());
+
+      if (got == population_map->end() || got->second != root) {
+        Rcpp::stop("pedigrees were not built for this population");
+      }
+
+      pedigrees_individuals += ped->get_all_individuals()->size();
+    }
+
+    if (pedigrees_individuals != population_map->size()) {
+      Rcpp::stop("pedigrees were not built for this population");
+    }
+
+    // Pedigree destructor unsets the individuals' pedigrees
+    for (auto ped : *peds) {
+      delete ped;
+    }
+
+    peds->clear();
+  }
+
+  // Haplotypes are invalidated, and find founders (oldest generation) and next pid
+  std::vector<Individual*> children_generation(population_size, nullptr);
+  size_t founders = 0;
+  int individual_id = 1;
+
+  for (auto it = population_map->begin(); it != population_map->end(); ++it) {
+    Individual* indv = it->second;
+    indv->unset_haplotype();
+
+    if (indv->get_pid() >= individual_id) {
+      individual_id = indv->get_pid() + 1;
+    }
+
+    if (indv->get_father() == nullptr && indv->get_generation() == generations_simulated - 1) {
+      if (founders >= population_size) {
+        Rcpp::stop("More founders than population size");
+      }
+
+      children_generation[founders] = indv;
+      founders += 1;
+    }
+  }
+
+  if (founders != (size_t)founders_left) {
+    Rcpp::stop("The founders in the population do not match simulation");
+  }
+
+  WFRandomFather wf_random_father(population_size);
+  GammaVarianceRandomFather gamma_variance_father(population_size, gamma_parameter_shape, gamma_parameter_scale);
+  SimulateChooseFather* choose_father = &wf_random_father;
+
+  if (sdo_type == "GammaVariation") {
+    choose_father = &gamma_variance_father;
+  }
+
+  bool simulate_fixed_number_generations = (generations == -1) ? false : true;
+  int generations_end = generations_simulated + generations;
+
+  Progress progress_bar((simulate_fixed_number_generations) ? generations : 1000, progress);
+  std::vector<Individual*> last_k_generations; // not used: new generations are not returned
+
+  int generation = generations_simulated;
+  while ((simulate_fixed_number_generations == true && generation < generations_end) || (simulate_fixed_number_generations == false && founders_left > 1)) {
+    generation = continue_geneology_constant_size(population_map, children_generation,
+      generation, generation + 1, -1, -1, choose_father,
+      last_k_generations, &individual_id, &founders_left);
+
+    // the population is consistent after each generation, so return what has been simulated
+    if (Progress::check_abort()) {
+      Rcpp::warning("Aborted, returning the generations simulated so far");
+      break;
+    }
+
+    if (progress) {
+      progress_bar.increment();
+    }
+  }
+
+  population->invalidate_generation_index();
+
+  List res = clone(simulation);
+  res["generations"] = generation;
+  res["founders"] = founders_left;
+
+  return res;
+}
+
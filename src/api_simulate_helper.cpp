@@ -13,6 +13,8 @@
 
 #include <progress.hpp>
 
+#include <algorithm>
+
 #include "malan_types.h"
 #include "api_simulate.h"
 
@@ -78,3 +80,220 @@ void create_father_update_simulation_state_varying_size(
   }  
 }
 
+// The individuals in a generation (of population_size, nullptr if not simulated) 
+// as a sparse list of (index, individual) sorted by index.
+void lineages_from_generation(
+  const std::vector<Individual*>& generation_individuals,
+  std::vector< std::pair<int, Individual*> >& lineages) {
+  
+  lineages.clear();
+  
+  for (size_t i = 0; i < generation_individuals.size(); ++i) {
+    if (generation_individuals[i] != nullptr) {
+      lineages.push_back(std::make_pair((int)i, generation_individuals[i]));
+    }
+  }
+}
+
+// Sparse (occupancy) path for a generation: when only k of the population_size 
+// children have descendants, draw their fathers in O(k) (up to sorting) instead of 
+// running through all population_size children and fathers.
+// The fathers are drawn in the same order (by increasing child index) and hence 
+// with the same random numbers as the dense loop, and get the same pids.
+// lineages (index, individual; sorted by index) is replaced by the fathers, 
+// and new_fathers is the fathers in the order created (by increasing pid).
+void simulate_generation_sparse(
+  std::vector< std::pair<int, Individual*> >& lineages,
+  SimulateChooseFather* choose_father,
+  int generation,
+  int* individual_id,
+  std::unordered_map<int, Individual*>& drawn_fathers,
+  std::vector<Individual*>& new_fathers) {
+  
+  std::vector< std::pair<int, Individual*> > fathers;
+  fathers.reserve(lineages.size());
+  drawn_fathers.clear();
+  new_fathers.clear();
+  
+  for (auto& lineage : lineages) {
+    int father_i = choose_father->get_father_i();
+    auto got = drawn_fathers.find(father_i);
+    Individual* father = nullptr;
+    
+    // if this is the father's first child, create the father
+    if (got == drawn_fathers.end()) {
+      father = new Individual((*individual_id)++, generation);
+      drawn_fathers[father_i] = father;
+      new_fathers.push_back(father);
+      fathers.push_back(std::make_pair(father_i, father));
+    } else {
+      father = got->second;
+    }
+    
+    father->add_child(lineage.second);
+  }
+  
+  std::sort(fathers.begin(), fathers.end());
+  lineages.swap(fathers);
+}
+
+// Simulate a geneology with constant population size.
+// Same model as sample_geneology(), but no R objects are created and 
+// R is never called (provided choose_father does not use R's RNG), 
+// so this can be run from worker threads.
+// Used in sample_geneology_replicates()
+Population* simulate_geneology_constant_size(
+  size_t population_size, 
+  int generations,
+  int extra_generations_full,
+  int individuals_generations_return,
+  SimulateChooseFather* choose_father,
+  std::vector<Individual*>& end_generation,
+  std::vector<Individual*>& last_k_generations,
+  int* generations_simulated,
+  int* founders_left) {
+  
+  std::unordered_map<int, Individual*>* population_map = new std::unordered_map<int, Individual*>(); // pid's are garanteed to be unique
+  Population* population = new Population(population_map);
+  
+  int individual_id = 1;
+  end_generation.resize(population_size);
+  last_k_generations.clear();
+  
+  for (size_t i = 0; i < population_size; ++i) {
+    Individual* indv = new Individual(individual_id++, 0);
+    end_generation[i] = indv;    
+    (*population_map)[indv->get_pid()] = indv;
+    
+    if (individuals_generations_return >= 0) {
+      last_k_generations.push_back(indv);
+    }
+  }
+  
+  std::vector<Individual*> children_generation(end_generation);
+  (*founders_left) = population_size;
+  
+  (*generations_simulated) = continue_geneology_constant_size(population_map, children_generation, 
+    1, generations, extra_generations_full, individuals_generations_return, choose_father, 
+    last_k_generations, &individual_id, founders_left);
+  
+  return population;
+}
+
+// Continue a simulation with constant population size backwards in time.
+// children_generation (of size population_size, some may be nullptr) is the 
+// oldest generation simulated so far, it is replaced by the oldest generation simulated.
+// Generations first_generation, first_generation + 1, ... are simulated until 
+// generation generations_end (exclusive) or, if generations_end is -1, until 
+// there is 1 founder left.
+// Returns the generation after the oldest simulated (as sample_geneology()'s generations).
+// Used in simulate_geneology_constant_size() and extend_geneology()
+int continue_geneology_constant_size(
+  std::unordered_map<int, Individual*>* population_map,
+  std::vector<Individual*>& children_generation,
+  int first_generation,
+  int generations_end,
+  int extra_generations_full,
+  int individuals_generations_return,
+  SimulateChooseFather* choose_father,
+  std::vector<Individual*>& last_k_generations,
+  int* individual_id,
+  int* founders_left) {
+  
+  bool simulate_fixed_number_generations = (generations_end == -1) ? false : true;
+  size_t population_size = children_generation.size();
+  std::vector<Individual*> fathers_generation(population_size);
+  
+  bool sparse = false;
+  std::vector< std::pair<int, Individual*> > lineages;
+  std::unordered_map<int, Individual*> drawn_fathers;
+  std::vector<Individual*> new_fathers;
+  
+  int generation = first_generation;
+  while ((simulate_fixed_number_generations == true && generation < generations_end) || (simulate_fixed_number_generations == false && (*founders_left) > 1)) {
+    if (!sparse && choose_father->is_uniform() && generation > extra_generations_full && 
+        (size_t)(*founders_left) * SPARSE_LINEAGES_FRACTION < population_size) {
+      sparse = true;
+      lineages_from_generation(children_generation, lineages);
+    }
+    
+    if (sparse) {
+      choose_father->update_state_new_generation();
+      simulate_generation_sparse(lineages, choose_father, generation, individual_id, drawn_fathers, new_fathers);
+      
+      for (auto father : new_fathers) {
+        (*population_map)[father->get_pid()] = father;
+        
+        if (generation <= individuals_generations_return) {
+          last_k_generations.push_back(father);
+        }
+      }
+      
+      (*founders_left) = lineages.size();
+      generation += 1;
+      continue;
+    }
+    
+    int new_founders_left = 0;
+    
+    std::fill(fathers_generation.begin(), fathers_generation.end(), nullptr);
+    
+    choose_father->update_state_new_generation();
+    
+    for (size_t i = 0; i < population_size; ++i) {
+      // if a child did not have children himself, forget his ancestors
+      if (children_generation[i] == nullptr) {
+        continue;
+      }
+      
+      int father_i = choose_father->get_father_i();
+      
+      // if this is the father's first child, create the father
+      if (fathers_generation[father_i] == nullptr) {
+        Individual* father = new Individual((*individual_id)++, generation);
+        fathers_generation[father_i] = father;
+        (*population_map)[father->get_pid()] = father;
+        new_founders_left += 1;
+        
+        if (generation <= individuals_generations_return) {
+          last_k_generations.push_back(father);
+        }
+      }
+      
+      fathers_generation[father_i]->add_child(children_generation[i]);
+    }
+    
+    // create additional fathers (without children) if needed:
+    if (generation <= extra_generations_full) {
+      for (size_t father_i = 0; father_i < population_size; ++father_i) {
+        if (fathers_generation[father_i] != nullptr) {
+          continue;
+        }
+        
+        Individual* father = new Individual((*individual_id)++, generation);
+        fathers_generation[father_i] = father;
+        (*population_map)[father->get_pid()] = father;
+        new_founders_left += 1;
+        
+        if (generation <= individuals_generations_return) {
+          last_k_generations.push_back(father);
+        }
+      }
+    }
+    
+    children_generation.swap(fathers_generation);
+    
+    (*founders_left) = new_founders_left;
+    generation += 1;
+  }
+  
+  if (sparse) {
+    std::fill(children_generation.begin(), children_generation.end(), nullptr);
+    
+    for (auto& lineage : lineages) {
+      children_generation[lineage.first] = lineage.second;
+    }
+  }
+  
+  return generation;
+}
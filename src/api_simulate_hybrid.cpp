@@ -0,0 +1,239 @@
+/**
+ api_simulate_hybrid.cpp
+ Purpose: Logic to simulate recent generations exactly and the deep ancestry by the coalescent.
+ Details: API between R user and C++ logic.
+
+ @author Mikkel Meyer Andersen
+ */
+
+#include <RcppArmadillo.h>
+
+// [[Rcpp::depends(RcppProgress)]]
+// [[Rcpp::depends(RcppArmadillo)]]
+
+#include <progress.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include "malan_types.h"
+#include "api_simulate.h"
+
+using namespace Rcpp;
+
+//' Simulate a geneology with the recent generations exact and the deep ancestry by the coalescent
+//'
+//' Simulates the last `generations_exact` generations exactly as [sample_geneology()]
+//' (standard Wright-Fisher), and then the ancestry of the founders of the exact part
+//' (the lineages left) by Kingman's coalescent until their most recent common ancestor:
+//' with `k` lineages, the time to the next coalescence is exponential with rate
+//' \eqn{k(k-1)/(2N)} per generation (\eqn{N} is `population_size`), and two lineages
+//' chosen uniformly at random coalesce. Times are rounded up to whole generations
+//' (so several coalescences can happen in the same generation, giving branches of length 0).
+//'
+//' The coalescent is not part of the population (no individuals are created for it), so
+//' the time used for it only depends on the number of lineages left and not on `population_size`.
+//' Pedigrees are built for the exact part only by [build_pedigrees()] (a pedigree per lineage),
+//' and haplotypes are populated by [pedigrees_all_populate_haplotypes_hybrid()], where the
+//' founders' haplotypes are drawn from the coalescent.
+//'
+//' As in [sample_geneology()], R's random number generator is used.
+//'
+//' @param population_size The size of the population.
+//' @param generations_exact The number of generations to simulate exactly (at least 1).
+//' @param generations_full Number of full generations to be simulated (in the exact part).
+//' @param generations_return How many generations to return (pointers to) individuals for.
+//' @param progress Show progress.
+//'
+//' @return A malan_simulation object as returned by [sample_geneology()] for the exact part
+//' with the additional element `coalescent`: a data frame with a row per node
+//' (the founders of the exact part first, then the ancestors in the order they were created; the last is the root)
+//' with `pid` (of the founder; `NA` for ancestors), `parent` (row of the ancestor, `NA` for the root) and `generation`.
+//'
+//' @seealso [sample_geneology()] and [pedigrees_all_populate_haplotypes_hybrid()].
+//'
+//' @export
+// [[Rcpp::export]]
+List sample_geneology_hybrid(size_t population_size,
+                             int generations_exact,
+                             int generations_full = 1,
+                             int generations_return = 3,
+                             bool progress = true) {
+
+  if (generations_exact < 1) {
+    Rcpp::stop("generations_exact must be at least 1");
+  }
+
+  List res = sample_geneology(population_size, generations_exact, generations_full, generations_return,
+                              false, 5.0, 1.0/5.0, progress, false, false);
+
+  Rcpp::XPtr<Population> population = res["population"];
+  std::unordered_map<int, Individual*>* population_map = population->get_population();
+  int generations = Rcpp::as<int>(res["generations"]);
+  int founders_left = Rcpp::as<int>(res["founders"]);
+
+  // leaves: the founders of the exact part (sorted by pid for reproducibility)
+  std::vector<int> node_pid;
+
+  for (auto it = population_map->begin(); it != population_map->end(); ++it) {
+    Individual* indv = it->second;
+
+    if (indv->get_father() == nullptr && indv->get_generation() == generations - 1) {
+      node_pid.push_back(indv->get_pid());
+    }
+  }
+
+  if (node_pid.size() != (size_t)founders_left) {
+    Rcpp::stop("The founders in the population do not match the simulation");
+  }
+
+  std::sort(node_pid.begin(), node_pid.end());
+
+  size_t leaves = node_pid.size();
+  std::vector<int> node_parent(leaves, -1);
+  std::vector<int> node_generation(leaves, generations - 1);
+  std::vector<int> lineages(leaves);
+
+  for (size_t i = 0; i < leaves; ++i) {
+    lineages[i] = i;
+  }
+
+  RNG* rng = get_R_rng();
+  double N = (double)population_size;
+  double t = (double)(generations - 1);
+
+  while (lineages.size() > 1) {
+    double k = (double)lineages.size();
+    double rate = k*(k - 1.0) / (2.0*N);
+    t += -std::log(rng->unif_rand()) / rate;
+
+    // two distinct lineages
+    size_t i = rng->unif_rand() * k;
+    size_t j = rng->unif_rand() * (k - 1.0);
+
+    if (j >= i) {
+      j += 1;
+    }
+
+    int ancestor = node_parent.size();
+    node_parent.push_back(-1);
+    node_pid.push_back(NA_INTEGER);
+    node_generation.push_back((int)std::ceil(t));
+
+    node_parent[lineages[i]] = ancestor;
+    node_parent[lineages[j]] = ancestor;
+
+    // replace i by the ancestor, remove j
+    lineages[i] = ancestor;
+    lineages[j] = lineages.back();
+    lineages.pop_back();
+  }
+
+  size_t nodes = node_parent.size();
+  IntegerVector parent(nodes);
+
+  for (size_t i = 0; i < nodes; ++i) {
+    parent[i] = (node_parent[i] == -1) ? NA_INTEGER : node_parent[i] + 1;
+  }
+
+  res["coalescent"] = DataFrame::create(
+    Named("pid") = node_pid,
+    Named("parent") = parent,
+    Named("generation") = node_generation);
+
+  return res;
+}
+
+//' Populate haplotypes in pedigrees of a hybrid simulation
+//'
+//' Populates haplotypes as [pedigrees_all_populate_haplotypes()], but where the founders
+//' of the exact part of a simulation by [sample_geneology_hybrid()] get haplotypes from the coalescent:
+//' the root of the coalescent gets haplotype `rep(0L, loci)` and each node gets its parent's haplotype
+//' with mutations along the branch between them (of length \eqn{L} generations):
+//' at each locus, the number of mutations is binomial with \eqn{L} trials and
+//' probability given by `mutation_rates`, and each mutation is one step up or down with equal probability.
+//' The number of random numbers drawn for a branch does not grow with its length (for R's generator).
+//'
+//' Pedigree roots that are not founders of the exact part (individuals without descendants
+//' in the end generation, only present with `generations_full > 1`)
+//' get haplotype `rep(0L, loci)` as in [pedigrees_all_populate_haplotypes()].
+//'
+//' Note, that pedigrees must first have been inferred by [build_pedigrees()].
+//'
+//' @param simulation A malan_simulation object as returned by [sample_geneology_hybrid()]
+//' @param pedigrees Pedigree list in which to populate haplotypes
+//' @param mutation_rates Vector with mutation rates, length `loci`
+//' @param progress Show progress
+//'
+//' @seealso [sample_geneology_hybrid()] and [pedigrees_all_populate_haplotypes()].
+//'
+//' @export
+// [[Rcpp::export]]
+void pedigrees_all_populate_haplotypes_hybrid(List simulation,
+                                              Rcpp::XPtr< std::vector<Pedigree*> > pedigrees,
+                                              Rcpp::NumericVector mutation_rates,
+                                              bool progress = true) {
+
+  if (!simulation.inherits("malan_simulation") || !simulation.containsElementNamed("coalescent")) {
+    Rcpp::stop("simulation must be a malan_simulation object returned by sample_geneology_hybrid()");
+  }
+
+  std::vector<double> mut_rates = Rcpp::as< std::vector<double> >(mutation_rates);
+  size_t loci = mut_rates.size();
+
+  DataFrame coalescent = Rcpp::as<DataFrame>(simulation["coalescent"]);
+  IntegerVector node_pid = coalescent["pid"];
+  IntegerVector node_parent = coalescent["parent"];
+  IntegerVector node_generation = coalescent["generation"];
+  size_t nodes = node_pid.size();
+
+  // uniforms for the mutations in pedigrees are drawn in bulk, see set_rng_compatibility()
+  BufferedRNG rng;
+
+  // a parent comes after its children, so go from the root (the last node) and down
+  std::vector< std::vector<int> > node_haplotype(nodes);
+  std::unordered_map<int, size_t> founder_node;
+
+  for (size_t i = nodes; i-- > 0; ) {
+    std::vector<int>& h = node_haplotype[i];
+
+    if (node_parent[i] == NA_INTEGER) {
+      h.assign(loci, 0);
+    } else {
+      int parent = node_parent[i] - 1;
+      int branch_length = node_generation[parent] - node_generation[i];
+      h = node_haplotype[parent];
+
+      for (size_t loc = 0; loc < loci; ++loc) {
+        int mutations = rng.binom_rand(branch_length, mut_rates[loc]);
+        int up = rng.binom_rand(mutations, 0.5);
+        h[loc] += up - (mutations - up);
+      }
+    }
+
+    if (node_pid[i] != NA_INTEGER) {
+      founder_node[node_pid[i]] = i;
+    }
+  }
+
+  std::vector<int> h_zero(loci, 0);
+  size_t N = pedigrees->size();
+  Progress p(N, progress);
+
+  for (size_t i = 0; i < N; ++i) {
+    Pedigree* ped = pedigrees->at(i);
+    auto got = founder_node.find(ped->get_root()->get_pid());
+    const std::vector<int>& h = (got == founder_node.end()) ? h_zero : node_haplotype[got->second];
+
+    ped->populate_haplotypes_root_haplotype(h, mut_rates, &rng);
+
+    if (i % CHECK_ABORT_EVERY == 0 && Progress::check_abort()) {
+      Rcpp::stop("Aborted.");
+    }
+
+    if (progress) {
+      p.increment();
+    }
+  }
+}
+
@@ -0,0 +1,237 @@
+/**
+ api_simulate_lineages.cpp
+ Purpose: Logic to simulate the geneology of a sample from a population of constant size.
+ Details: API between R user and C++ logic.
+
+ @author Mikkel Meyer Andersen
+ */
+
+#include <RcppArmadillo.h>
+
+// [[Rcpp::depends(RcppProgress)]]
+// [[Rcpp::depends(RcppArmadillo)]]
+
+#include <progress.hpp>
+
+#include <unordered_map>
+
+#include "malan_types.h"
+
+using namespace Rcpp;
+
+//' Simulate the geneology of a sample
+//'
+//' Simulates the same model as [sample_geneology()], but only for
+//' `sample_size` men (the sample) in the end generation of a population
+//' of `population_size` men.
+//' Only the sample and their ancestors are created, and the time used
+//' is proportional to the number of ancestors (at most `sample_size` per generation),
+//' not to `population_size`, so `population_size` can be very large.
+//'
+//' In each generation, the fathers of the current lineages are drawn amongst
+//' `population_size` men and only the fathers drawn are created
+//' (those drawn more than once are found by hashing).
+//' For the symmetric Dirichlet (gamma variance) model, the men's
+//' probabilities to be a father are integrated out: the children draw their fathers
+//' sequentially (as in a Polya urn), so a man who is already a father
+//' of `c` of the children is drawn with probability proportional to \eqn{\alpha + c}
+//' where \eqn{\alpha} is `gamma_parameter_shape`.
+//' This is the same distribution as in [sample_geneology()]
+//' (`gamma_parameter_scale` cancels out in the normalisation, and is not used).
+//'
+//' As in [sample_geneology()], R's random number generator is used.
+//'
+//' @param population_size The size of the population.
+//' @param sample_size The number of men in the end generation to simulate the geneology of.
+//' @param generations The number of generations to simulate:
+//'        \itemize{
+//'           \item -1 for simulate to 1 founder
+//'           \item else simulate this number of generations.
+//'        }
+//' @param generations_return How many generations to return (pointers to) individuals for.
+//' @param enable_gamma_variance_extension Enable symmetric Dirichlet (and disable standard Wright-Fisher).
+//' @param gamma_parameter_shape Parameter related to symmetric Dirichlet distribution for each man's probability to be father. Refer to details.
+//' @param gamma_parameter_scale Parameter realted to symmetric Dirichlet distribution for each man's probability to be father. Not used, refer to details.
+//' @param progress Show progress.
+//'
+//' @return A malan_simulation object as returned by [sample_geneology()]
+//' (without the verbose components) where `end_generation_individuals` is the sample,
+//' with the additional elements `population_size` and `sample_size`.
+//'
+//' @seealso [sample_geneology()].
+//'
+//' @export
+// [[Rcpp::export]]
+List sample_geneology_lineages(size_t population_size,
+                               size_t sample_size,
+                               int generations,
+                               int generations_return = 3,
+                               bool enable_gamma_variance_extension = false,
+                               double gamma_parameter_shape = 5.0,
+                               double gamma_parameter_scale = 1.0/5.0,
+                               bool progress = true) {
+
+  if (population_size < 1) {
+    Rcpp::stop("Please specify population_size >= 1");
+  }
+
+  if (sample_size < 1 || sample_size > population_size) {
+    Rcpp::stop("Please specify sample_size >= 1 and <= population_size");
+  }
+
+  if (generations < -1 || generations == 0) {
+    Rcpp::stop("Please specify generations as -1 (for simulation to 1 founder) or > 0");
+  }
+
+  if (generations_return <= 0) {
+    Rcpp::stop("generations_return must be at least 1");
+  }
+  int individuals_generations_return = generations_return - 1;
+
+  if (enable_gamma_variance_extension) {
+    if (gamma_parameter_shape <= 0.0) {
+      Rcpp::stop("gamma_parameter_shape must be > 0.0");
+    }
+    if (gamma_parameter_scale <= 0.0) {
+      Rcpp::stop("gamma_parameter_scale must be > 0.0");
+    }
+  }
+
+  bool simulate_fixed_number_generations = (generations == -1) ? false : true;
+
+  Progress progress_bar((simulate_fixed_number_generations) ? generations : 1000, progress);
+
+  std::unordered_map<int, Individual*>* population_map = new std::unordered_map<int, Individual*>(); // pid's are garanteed to be unique
+  Population* population = new Population(population_map);
+  Rcpp::XPtr<Population> population_xptr(population, RCPP_XPTR_2ND_ARG_CLEANER);
+  population_xptr.attr("class") = CharacterVector::create("malan_population", "externalptr");
+
+  int individual_id = 1;
+  List end_generation_individuals(sample_size);
+  List last_k_generations_individuals;
+
+  // current lineages (the oldest generation simulated)
+  std::vector<Individual*> children_generation(sample_size);
+  std::vector<Individual*> fathers_generation;
+
+  for (size_t i = 0; i < sample_size; ++i) {
+    Individual* indv = new Individual(individual_id++, 0);
+    children_generation[i] = indv;
+    (*population_map)[indv->get_pid()] = indv;
+
+    Rcpp::XPtr<Individual> indv_xptr(indv, RCPP_XPTR_2ND_ARG);
+    end_generation_individuals[i] = indv_xptr;
+
+    if (individuals_generations_return >= 0) {
+      last_k_generations_individuals.push_back(indv_xptr);
+    }
+  }
+
+  // Wright-Fisher: the father (if created) of each of the population_size men
+  std::unordered_map<size_t, Individual*> drawn_fathers;
+
+  // Gamma variance: index in fathers_generation of the father of each child so far
+  std::vector<size_t> children_father;
+  double alpha = gamma_parameter_shape;
+  double population_size_alpha = (double)population_size * alpha;
+
+  // uniforms for the fathers are drawn in bulk, see set_rng_compatibility()
+  BufferedRNG rng;
+
+  int founders_left = sample_size;
+  int generation = 1;
+
+  while ((simulate_fixed_number_generations == true && generation < generations) || (simulate_fixed_number_generations == false && founders_left > 1)) {
+    size_t children = children_generation.size();
+
+    fathers_generation.clear();
+    drawn_fathers.clear();
+    children_father.clear();
+
+    rng.reserve(children); // one uniform per child
+
+    for (size_t k = 0; k < children; ++k) {
+      if (k % CHECK_ABORT_EVERY == 0 && Progress::check_abort()) {
+        stop("Aborted");
+      }
+
+      Individual* father = nullptr;
+
+      if (!enable_gamma_variance_extension) {
+        size_t father_i = rng.unif_rand() * population_size;
+        auto got = drawn_fathers.find(father_i);
+
+        if (got != drawn_fathers.end()) {
+          father = got->second;
+        } else {
+          father = new Individual(individual_id++, generation);
+          drawn_fathers[father_i] = father;
+          fathers_generation.push_back(father);
+        }
+      } else {
+        // the k previous children have weight 1 each (picks a father proportional to his children),
+        // the fathers drawn so far have weight alpha each and the remaining men alpha each
+        size_t fathers = fathers_generation.size();
+        double u = rng.unif_rand() * (population_size_alpha + (double)k);
+        size_t father_index;
+
+        if (u < (double)k) {
+          father_index = children_father[std::min((size_t)u, k - 1)];
+        } else if (u < (double)k + (double)fathers * alpha) {
+          father_index = std::min((size_t)((u - (double)k) / alpha), fathers - 1);
+        } else {
+          father_index = fathers;
+          fathers_generation.push_back(new Individual(individual_id++, generation));
+        }
+
+        children_father.push_back(father_index);
+        father = fathers_generation[father_index];
+      }
+
+      father->add_child(children_generation[k]);
+    }
+
+    for (auto father : fathers_generation) {
+      (*population_map)[father->get_pid()] = father;
+
+      if (generation <= individuals_generations_return) {
+        Rcpp::XPtr<Individual> father_xptr(father, RCPP_XPTR_2ND_ARG);
+        last_k_generations_individuals.push_back(father_xptr);
+      }
+    }
+
+    children_generation.swap(fathers_generation);
+    founders_left = children_generation.size();
+
+    if (Progress::check_abort()) {
+      stop("Aborted");
+    }
+
+    if (progress) {
+      progress_bar.increment();
+    }
+
+    generation += 1;
+  }
+
+  List res;
+  res["population"] = population_xptr;
+  res["generations"] = generation;
+  res["founders"] = founders_left;
+  res["growth_type"] = "ConstantPopulationSize";
+  res["sdo_type"] = (enable_gamma_variance_extension) ? "GammaVariation" : "StandardWF";
+  res["end_generation_individuals"] = end_generation_individuals;
+  res["individuals_generations"] = last_k_generations_individuals;
+  res["population_size"] = population_size;
+  res["sample_size"] = sample_size;
+
+  if (enable_gamma_variance_extension) {
+    res["gamma_parameter_shape"] = gamma_parameter_shape;
+    res["gamma_parameter_scale"] = gamma_parameter_scale;
+  }
+
+  res.attr("class") = CharacterVector::create("malan_simulation", "list");
+
+  return res;
+}
+
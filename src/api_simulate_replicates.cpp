@@ -0,0 +1,289 @@
+/**
+ api_simulate_replicates.cpp
+ Purpose: Logic to simulate many independent populations of constant size.
+ Details: API between R user and C++ logic.
+  
+ @author Mikkel Meyer Andersen
+ */
+
+#include <RcppArmadillo.h>
+
+// [[Rcpp::depends(RcppProgress)]]
+// [[Rcpp::depends(RcppArmadillo)]]
+
+#include <progress.hpp>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "malan_types.h"
+#include "api_simulate.h"
+
+using namespace Rcpp;
+
+// Number of distinct male lines (roots) and size of the largest one.
+// Does not use pedigrees (and does not call R) so it can run in worker threads.
+void replicate_lineage_summary(Population* population, int* lineages, int* max_lineage_size) {
+  std::unordered_map<int, Individual*>* pop = population->get_population();
+  std::unordered_map<Individual*, Individual*> root_of;
+  std::unordered_map<Individual*, int> lineage_size;
+  std::vector<Individual*> path;
+
+  for (auto it = pop->begin(); it != pop->end(); ++it) {
+    Individual* x = it->second;
+    path.clear();
+
+    // walk up until the root or an individual with known root
+    while (x->get_father() != nullptr && root_of.find(x) == root_of.end()) {
+      path.push_back(x);
+      x = x->get_father();
+    }
+
+    auto got = root_of.find(x);
+    Individual* root = (got == root_of.end()) ? x : got->second;
+
+    for (auto p : path) {
+      root_of[p] = root;
+    }
+
+    lineage_size[root] += 1;
+  }
+
+  (*lineages) = lineage_size.size();
+  (*max_lineage_size) = 0;
+
+  for (auto it = lineage_size.begin(); it != lineage_size.end(); ++it) {
+    if (it->second > (*max_lineage_size)) {
+      (*max_lineage_size) = it->second;
+    }
+  }
+}
+
+//' Simulate replicate geneologies with constant population size.
+//'
+//' This function simulates `replicates` independent geneologies using the same
+//' model as [sample_geneology()]. Replicates are simulated in parallel
+//' (one replicate per thread at a time).
+//'
+//' Each replicate uses its own random number stream.
+//' All streams are derived from `seed` and do not overlap,
+//' so results only depend on `seed` and not on the number of threads.
+//' If `seed` is `NA`, it is drawn from R's random number generator,
+//' hence `set.seed()` can be used for reproducibility.
+//' Note that the streams are not R's, so the populations differ from
+//' those obtained by calling [sample_geneology()] repeatedly.
+//'
+//' If only summaries are needed, use `summary = "sizes"`: then
+//' each population is discarded as soon as it is summarised, so
+//' at most one population per thread is held in memory.
+//'
+//' @inheritParams sample_geneology
+//' @param replicates Number of populations to simulate.
+//' @param summary Either `"population"` (return the populations) or
+//' `"sizes"` (return a matrix with one row of summary statistics per replicate).
+//' @param seed Seed for the random number streams; `NA` means draw from R's random number generator.
+//' @param threads Number of threads; 0 means the OpenMP default.
+//'
+//' @return If `summary = "population"`: a list of `replicates` malan_simulation objects
+//' (as returned by [sample_geneology()], but without the verbose components).
+//' If `summary = "sizes"`: an integer matrix with a row per replicate and columns
+//' `generations` (generations actually simulated),
+//' `founders` (number of founders),
+//' `individuals` (number of individuals simulated),
+//' `lineages` (number of male lines, i.e. pedigrees) and
+//' `max_lineage_size` (size of the largest male line).
+//'
+//' @seealso [sample_geneology()].
+//'
+//' @export
+// [[Rcpp::export]]
+RObject sample_geneology_replicates(int replicates,
+  size_t population_size,
+  int generations,
+  int generations_full = 1,
+  int generations_return = 3,
+  bool enable_gamma_variance_extension = false,
+  double gamma_parameter_shape = 5.0, double gamma_parameter_scale = 1.0/5.0,
+  std::string summary = "population",
+  int seed = NA_INTEGER,
+  int threads = 0,
+  bool progress = true) {
+
+  if (replicates < 1) {
+    Rcpp::stop("replicates must be at least 1");
+  }
+
+  if (generations_full <= 0) {
+    Rcpp::stop("generations_full must be at least 1");
+  }
+  int extra_generations_full = generations_full - 1;
+
+  if (generations_return <= 0) {
+    Rcpp::stop("generations_return must be at least 1");
+  }
+  int individuals_generations_return = generations_return - 1;
+
+  if (population_size < 1) {
+    Rcpp::stop("Please specify population_size >= 1");
+  }
+  if (generations < -1 || generations == 0) {
+    Rcpp::stop("Please specify generations as -1 (for simulation to 1 founder) or > 0");
+  }
+
+  if (enable_gamma_variance_extension) {
+    if (gamma_parameter_shape <= 0.0) {
+      Rcpp::stop("gamma_parameter_shape must be > 0.0");
+    }
+    if (gamma_parameter_scale <= 0.0) {
+      Rcpp::stop("gamma_parameter_scale must be > 0.0");
+    }
+  }
+
+  bool keep_population = false;
+
+  if (summary == "population") {
+    keep_population = true;
+  } else if (summary != "sizes") {
+    Rcpp::stop("summary must be either 'population' or 'sizes'");
+  }
+
+  if (threads < 0) {
+    Rcpp::stop("threads must be >= 0");
+  }
+
+  uint64_t base_seed = (seed == NA_INTEGER) ? draw_seed_from_R() : (uint64_t)seed;
+
+#ifdef _OPENMP
+  if (threads == 0) {
+    threads = omp_get_max_threads();
+  }
+#else
+  threads = 1;
+#endif
+
+  std::vector<Population*> populations(replicates, nullptr);
+  std::vector< std::vector<Individual*> > end_generations(keep_population ? replicates : 0);
+  std::vector< std::vector<Individual*> > last_k_generations(keep_population ? replicates : 0);
+
+  Rcpp::IntegerMatrix sizes(replicates, 5);
+  colnames(sizes) = CharacterVector::create("generations", "founders", "individuals", "lineages", "max_lineage_size");
+  std::vector<int> res_generations(replicates);
+  std::vector<int> res_founders(replicates);
+  std::vector<int> res_individuals(replicates);
+  std::vector<int> res_lineages(replicates);
+  std::vector<int> res_max_lineage_size(replicates);
+
+  Progress progress_bar(replicates, progress);
+  bool aborted = false;
+
+  #pragma omp parallel for schedule(dynamic, 1) num_threads(threads)
+  for (int r = 0; r < replicates; ++r) {
+    if (aborted) {
+      continue;
+    }
+
+    StreamRNG rng(base_seed, r);
+    WFRandomFather wf_random_father(population_size, &rng);
+    GammaVarianceRandomFather gamma_variance_father(population_size, gamma_parameter_shape, gamma_parameter_scale, &rng);
+    SimulateChooseFather* choose_father = &wf_random_father;
+
+    if (enable_gamma_variance_extension) {
+      choose_father = &gamma_variance_father;
+    }
+
+    std::vector<Individual*> end_generation;
+    std::vector<Individual*> last_k;
+    int generations_simulated = 0;
+    int founders_left = 0;
+
+    Population* population = simulate_geneology_constant_size(population_size, generations,
+      extra_generations_full, individuals_generations_return, choose_father,
+      end_generation, last_k, &generations_simulated, &founders_left);
+
+    res_generations[r] = generations_simulated;
+    res_founders[r] = founders_left;
+    res_individuals[r] = population->get_population_size();
+
+    if (keep_population) {
+      populations[r] = population;
+      end_generations[r].swap(end_generation);
+      last_k_generations[r].swap(last_k);
+    } else {
+      replicate_lineage_summary(population, &(res_lineages[r]), &(res_max_lineage_size[r]));
+      delete population;
+    }
+
+    // only master thread checks (and the progress bar is thread safe)
+    if (Progress::check_abort()) {
+      aborted = true;
+    }
+
+    if (progress) {
+      progress_bar.increment();
+    }
+  }
+
+  if (aborted) {
+    for (auto population : populations) {
+      if (population != nullptr) {
+        delete population;
+      }
+    }
+
+    Rcpp::stop("Aborted");
+  }
+
+  if (!keep_population) {
+    for (int r = 0; r < replicates; ++r) {
+      sizes(r, 0) = res_generations[r];
+      sizes(r, 1) = res_founders[r];
+      sizes(r, 2) = res_individuals[r];
+      sizes(r, 3) = res_lineages[r];
+      sizes(r, 4) = res_max_lineage_size[r];
+    }
+
+    return sizes;
+  }
+
+  // Wrap in R objects (main thread only)
+  List res(replicates);
+
+  for (int r = 0; r < replicates; ++r) {
+    Rcpp::XPtr<Population> population_xptr(populations[r], RCPP_XPTR_2ND_ARG_CLEANER);
+    population_xptr.attr("class") = CharacterVector::create("malan_population", "externalptr");
+
+    List end_generation_individuals(end_generations[r].size());
+    for (size_t i = 0; i < end_generations[r].size(); ++i) {
+      Rcpp::XPtr<Individual> indv_xptr(end_generations[r][i], RCPP_XPTR_2ND_ARG);
+      end_generation_individuals[i] = indv_xptr;
+    }
+
+    List last_k_generations_individuals(last_k_generations[r].size());
+    for (size_t i = 0; i < last_k_generations[r].size(); ++i) {
+      Rcpp::XPtr<Individual> indv_xptr(last_k_generations[r][i], RCPP_XPTR_2ND_ARG);
+      last_k_generations_individuals[i] = indv_xptr;
+    }
+
+    List sim;
+    sim["population"] = population_xptr;
+    sim["generations"] = res_generations[r];
+    sim["founders"] = res_founders[r];
+    sim["growth_type"] = "ConstantPopulationSize";
+    sim["sdo_type"] = (enable_gamma_variance_extension) ? "GammaVariation" : "StandardWF";
+    sim["end_generation_individuals"] = end_generation_individuals;
+    sim["individuals_generations"] = last_k_generations_individuals;
+
+    if (enable_gamma_variance_extension) {
+      sim["gamma_parameter_shape"] = gamma_parameter_shape;
+      sim["gamma_parameter_scale"] = gamma_parameter_scale;
+    }
+
+    sim.attr("class") = CharacterVector::create("malan_simulation", "list");
+
+    res[r] = sim;
+  }
+
+  return res;
+}
+
@@ -0,0 +1,253 @@
+/**
+ api_simulate_stream.cpp
+ Purpose: Logic to simulate a geneology without keeping it in memory.
+ Details: API between R user and C++ logic.
+
+ @author Mikkel Meyer Andersen
+ */
+
+#include <RcppArmadillo.h>
+
+// [[Rcpp::depends(RcppProgress)]]
+// [[Rcpp::depends(RcppArmadillo)]]
+
+#include <progress.hpp>
+
+#include <algorithm>
+#include <memory>
+
+#include "malan_types.h"
+
+using namespace Rcpp;
+
+//' Simulate a geneology with constant population size, streaming the generations
+//'
+//' Simulates the same model as [sample_geneology()], but the geneology is not kept:
+//' for each generation, the father of each individual in the previous generation
+//' is given to a number of consumers (sinks) and then forgotten,
+//' so memory use is proportional to `population_size` regardless of
+//' the number of generations.
+//'
+//' The sinks are a binary file (if `file` is given) and a summary
+//' (if `summary` is `TRUE`). The file can be read by [read_geneology_stream()].
+//'
+//' As in [sample_geneology()], by default fathers are only drawn for
+//' individuals with descendants in the end generation (the others have no father, `NA`),
+//' and the random numbers used are the same as for [sample_geneology()]
+//' with `generations_full = 1`, so after the same `set.seed()` the two
+//' simulate the same geneology.
+//' If `all_fathers` is `TRUE`, a father is drawn for every individual in every generation.
+//'
+//' @param population_size The size of the population.
+//' @param generations The number of generations to simulate:
+//'        \itemize{
+//'           \item -1 for simulate to 1 founder
+//'           \item else simulate this number of generations.
+//'        }
+//' @param file Name of binary file to write the generations to; `""` for no file.
+//' @param summary Keep a summary of each generation.
+//' @param all_fathers Draw a father for every individual (not only those with descendants).
+//' @param enable_gamma_variance_extension Enable symmetric Dirichlet (and disable standard Wright-Fisher).
+//' @param gamma_parameter_shape Parameter related to symmetric Dirichlet distribution for each man's probability to be father. Refer to [sample_geneology()].
+//' @param gamma_parameter_scale Parameter realted to symmetric Dirichlet distribution for each man's probability to be father. Refer to [sample_geneology()].
+//' @param progress Show progress.
+//'
+//' @return A list with the simulation parameters, `generations` and `founders` as for
+//' [sample_geneology()] and, if `summary` is `TRUE`, `summary`: a data frame with a row per simulated generation
+//' with the number of individuals in the previous generation that a father was drawn for (`children`),
+//' the number of distinct fathers (`fathers`), the largest number of children of a father (`max_children`) 
+//' and the variance of the number of children over all `population_size` men (`offspring_var`).
+//'
+//' @seealso [sample_geneology()] and [read_geneology_stream()].
+//'
+//' @export
+// [[Rcpp::export]]
+List sample_geneology_stream(size_t population_size,
+                             int generations,
+                             std::string file = "",
+                             bool summary = true,
+                             bool all_fathers = false,
+                             bool enable_gamma_variance_extension = false,
+                             double gamma_parameter_shape = 5.0,
+                             double gamma_parameter_scale = 1.0/5.0,
+                             bool progress = true) {
+
+  if (population_size < 1) {
+    Rcpp::stop("Please specify population_size >= 1");
+  }
+
+  if (generations < -1 || generations == 0) {
+    Rcpp::stop("Please specify generations as -1 (for simulation to 1 founder) or > 0");
+  }
+
+  if (enable_gamma_variance_extension) {
+    if (gamma_parameter_shape <= 0.0) {
+      Rcpp::stop("gamma_parameter_shape must be > 0.0");
+    }
+    if (gamma_parameter_scale <= 0.0) {
+      Rcpp::stop("gamma_parameter_scale must be > 0.0");
+    }
+  }
+
+  std::vector<GenerationSink*> sinks;
+  std::unique_ptr<FileGenerationSink> file_sink;
+  SummaryGenerationSink summary_sink;
+
+  if (file != "") {
+    file_sink.reset(new FileGenerationSink(file, population_size));
+    sinks.push_back(file_sink.get());
+  }
+
+  if (summary) {
+    sinks.push_back(&summary_sink);
+  }
+
+  // uniforms for the fathers are drawn in bulk, see set_rng_compatibility()
+  BufferedRNG rng;
+  WFRandomFather wf_random_father(population_size, &rng);
+  GammaVarianceRandomFather gamma_variance_father(population_size, gamma_parameter_shape, gamma_parameter_scale, &rng);
+  SimulateChooseFather* choose_father = &wf_random_father;
+
+  if (enable_gamma_variance_extension) {
+    choose_father = &gamma_variance_father;
+  }
+
+  bool simulate_fixed_number_generations = (generations == -1) ? false : true;
+  Progress progress_bar((simulate_fixed_number_generations) ? generations : 1000, progress);
+
+  // only the current generation is kept
+  std::vector<char> children_descendants(population_size, 1); // has descendants in generation 0
+  std::vector<char> fathers_descendants(population_size);
+  std::vector<int> fathers(population_size);
+
+  int founders_left = population_size;
+  int generation = 1;
+
+  while ((simulate_fixed_number_generations == true && generation < generations) || (simulate_fixed_number_generations == false && founders_left > 1)) {
+    int new_founders_left = 0;
+    std::fill(fathers_descendants.begin(), fathers_descendants.end(), 0);
+
+    choose_father->update_state_new_generation();
+    rng.reserve(all_fathers ? population_size : founders_left); // one uniform per father drawn
+
+    for (size_t i = 0; i < population_size; ++i) {
+      if (i % CHECK_ABORT_EVERY == 0 && Progress::check_abort()) {
+        stop("Aborted");
+      }
+
+      if (!all_fathers && !children_descendants[i]) {
+        fathers[i] = -1;
+        continue;
+      }
+
+      int father_i = choose_father->get_father_i();
+      fathers[i] = father_i;
+
+      if (children_descendants[i] && !fathers_descendants[father_i]) {
+        fathers_descendants[father_i] = 1;
+        new_founders_left += 1;
+      }
+    }
+
+    for (auto sink : sinks) {
+      sink->consume(generation, fathers);
+    }
+
+    children_descendants.swap(fathers_descendants);
+    founders_left = new_founders_left;
+
+    if (Progress::check_abort()) {
+      stop("Aborted");
+    }
+
+    if (progress) {
+      progress_bar.increment();
+    }
+
+    generation += 1;
+  }
+
+  for (auto sink : sinks) {
+    sink->finish();
+  }
+
+  List res;
+  res["generations"] = generation;
+  res["founders"] = founders_left;
+  res["population_size"] = population_size;
+  res["growth_type"] = "ConstantPopulationSize";
+  res["sdo_type"] = (enable_gamma_variance_extension) ? "GammaVariation" : "StandardWF";
+
+  if (enable_gamma_variance_extension) {
+    res["gamma_parameter_shape"] = gamma_parameter_shape;
+    res["gamma_parameter_scale"] = gamma_parameter_scale;
+  }
+
+  if (file != "") {
+    res["file"] = file;
+  }
+
+  if (summary) {
+    res["summary"] = DataFrame::create(
+      Named("generation") = summary_sink.get_generation(),
+      Named("children") = summary_sink.get_children(),
+      Named("fathers") = summary_sink.get_fathers(),
+      Named("max_children") = summary_sink.get_max_children(),
+      Named("offspring_var") = summary_sink.get_offspring_var());
+  }
+
+  return res;
+}
+
+//' Read a streamed geneology
+//'
+//' Reads the binary file written by [sample_geneology_stream()].
+//'
+//' @param file Name of file written by [sample_geneology_stream()].
+//' @param generations The generations to read (1 is the generation of the fathers of the end generation); `NULL` for all.
+//'
+//' @return An integer matrix with a row per individual and a column per generation read
+//' (named by the generation): entry `[i, g]` is the index (1, 2, ..., population size)
+//' of the father of individual `i` in the generation before `g`, or `NA` if no father was drawn.
+//'
+//' @seealso [sample_geneology_stream()].
+//'
+//' @export
+// [[Rcpp::export]]
+IntegerMatrix read_geneology_stream(std::string file,
+                                    Rcpp::Nullable<Rcpp::IntegerVector> generations = R_NilValue) {
+
+  GenerationFileReader reader(file);
+  size_t population_size = reader.get_population_size();
+
+  std::vector<int> wanted;
+
+  if (generations.isNotNull()) {
+    wanted = Rcpp::as< std::vector<int> >(generations.get());
+  }
+
+  std::vector<size_t> records;
+
+  for (size_t k = 0; k < reader.get_records_count(); ++k) {
+    if (wanted.size() == 0 || std::find(wanted.begin(), wanted.end(), reader.get_generation(k)) != wanted.end()) {
+      records.push_back(k);
+    }
+  }
+
+  IntegerMatrix res(population_size, records.size());
+  CharacterVector names(records.size());
+
+  for (size_t g = 0; g < records.size(); ++g) {
+    names[g] = std::to_string(reader.get_generation(records[g]));
+    const int* fathers = reader.get_fathers(records[g]);
+
+    for (size_t i = 0; i < population_size; ++i) {
+      res(i, g) = (fathers[i] < 0) ? NA_INTEGER : fathers[i] + 1;
+    }
+  }
+
+  colnames(res) = names;
+
+  return res;
+}
+
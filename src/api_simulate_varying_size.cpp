@@ -166,18 +166,24 @@ List sample_geneology_varying_size(
   
   int founders_left = population_sizes[generations-1];
   
+  // uniforms for the fathers are drawn in bulk, see set_rng_compatibility()
+  BufferedRNG rng;
+  
+  // one chooser for all generations (its buffers are reused), resized per generation
+  WFRandomFather wf_random_father(population_sizes[generations-1], &rng);
+  GammaVarianceRandomFather gamma_variance_father(population_sizes[generations-1], gamma_parameter_shape, gamma_parameter_scale, &rng);  
+  SimulateChooseFather* choose_father = &wf_random_father;
+  if (enable_gamma_variance_extension) {
+    choose_father = &gamma_variance_father;
+  }
+  
   // now, find out who the fathers to the children are
   for (size_t generation = 1; generation < generations; ++generation) {
     // Init ->
     int population_size = population_sizes[generations-(generation+1)];    
     int children_population_size = population_sizes[generations-generation];
 
-    WFRandomFather wf_random_father(population_size);
-    GammaVarianceRandomFather gamma_variance_father(population_size, gamma_parameter_shape, gamma_parameter_scale);  
-    SimulateChooseFather* choose_father = &wf_random_father;
-    if (enable_gamma_variance_extension) {
-      choose_father = &gamma_variance_father;
-    }
+    choose_father->set_population_size(population_size);
     
     fathers_generation.clear();
     fathers_generation.resize(population_size);
@@ -191,6 +197,7 @@ List sample_geneology_varying_size(
     }
     
     choose_father->update_state_new_generation();
+    rng.reserve(founders_left); // one uniform per child with children
     
     // now, run through children to pick each child's father
     for (size_t i = 0; i < children_population_size; ++i) {
@@ -196,9 +196,10 @@ void pedigrees_all_populate_autosomal(Rcpp::XPtr< std::vector<Pedigree*> > pedig
   
   size_t N = peds.size();
   Progress p(N, progress);
+  BufferedRNG rng;
   
   for (size_t i = 0; i < N; ++i) {
-    peds.at(i)->populate_autosomal(cumdists, allele_cumdist_theta, alleles_count, mutation_rate);
+    peds.at(i)->populate_autosomal(cumdists, allele_cumdist_theta, alleles_count, mutation_rate, &rng);
     
     if (i % CHECK_ABORT_EVERY == 0 && Progress::check_abort()) {
       Rcpp::stop("Aborted.");
@@ -49,9 +49,10 @@ void pedigrees_all_populate_haplotypes(Rcpp::XPtr< std::vector<Pedigree*> > pedi
   
   size_t N = peds.size();
   Progress p(N, progress);
+  BufferedRNG rng;
   
   for (size_t i = 0; i < N; ++i) {
-    peds.at(i)->populate_haplotypes(loci, mut_rates);
+    peds.at(i)->populate_haplotypes(loci, mut_rates, &rng);
     
      if (i % CHECK_ABORT_EVERY == 0 && Progress::check_abort()) {
       Rcpp::stop("Aborted.");
@@ -98,9 +99,10 @@ void pedigrees_all_populate_haplotypes_custom_founders(Rcpp::XPtr< std::vector<P
 
   size_t N = peds.size();
   Progress p(N, progress);
+  BufferedRNG rng;
   
   for (size_t i = 0; i < N; ++i) {
-    peds.at(i)->populate_haplotypes_custom_founders(mut_rates, g_founder_hap);
+    peds.at(i)->populate_haplotypes_custom_founders(mut_rates, g_founder_hap, &rng);
     
      if (i % CHECK_ABORT_EVERY == 0 && Progress::check_abort()) {
       Rcpp::stop("Aborted.");
@@ -170,9 +172,10 @@ void pedigrees_all_populate_haplotypes_ladder_bounded(Rcpp::XPtr< std::vector<Pe
     
   size_t N = peds.size();
   Progress p(N, progress);
+  BufferedRNG rng;
   
   for (size_t i = 0; i < N; ++i) {
-    peds.at(i)->populate_haplotypes_ladder_bounded(mut_rates, lad_min, lad_max, g_founder_hap);
+    peds.at(i)->populate_haplotypes_ladder_bounded(mut_rates, lad_min, lad_max, g_founder_hap, &rng);
     
      if (i % CHECK_ABORT_EVERY == 0 && Progress::check_abort()) {
       Rcpp::stop("Aborted.");
@@ -492,9 +495,11 @@ int count_haplotype_occurrences_pedigree(Rcpp::XPtr<Pedigree> pedigree,
 //' max_L1 (on the path between the matching individual and `suspect`, 
 //' what is the maximum L1 distance between the `suspect`'s profile and the 
 //' profiles of the individuals on the path), 
-//' pid (pid of matching individual)
+//' pid (pid of matching individual), 
+//' mutations (on the path between the matching individual and `suspect`; 
+//' 0 if identical by descent, see [pedigrees_haplotype_matches_ibd()])
 //' 
-//' @seealso [count_haplotype_occurrences_individuals()].
+//' @seealso [count_haplotype_occurrences_individuals()] and [pedigrees_haplotype_matches_ibd()].
 //'
 //' @export
 // [[Rcpp::export]]
@@ -514,6 +519,7 @@ Rcpp::IntegerMatrix pedigree_haplotype_matches_in_pedigree_meiosis_L1_dists(cons
   std::vector<int> meiosis_dists;
   std::vector<int> max_L1_dists;
   std::vector<int> pids;
+  std::vector<int> path_mutations;
   
   // includes suspect by purpose
   for (auto dest : *family) { 
@@ -546,6 +552,7 @@ Rcpp::IntegerMatrix pedigree_haplotype_matches_in_pedigree_meiosis_L1_dists(cons
       //Rcpp::Rcout << ">> path from " << suspect->get_pid() << " to " << dest->get_pid() << " has length = " << meiosis_dist_from_path << " and meioses = " << meiosis_dist << (meiosis_dist_from_path == meiosis_dist ? " ok" : " ERROR") << ": " << std::endl;
       
       int max_L1 = 0;
+      int mutations = 0;
       
       //Rcpp::Rcout << "  ";
       
@@ -564,6 +571,11 @@ Rcpp::IntegerMatrix pedigree_haplotype_matches_in_pedigree_meiosis_L1_dists(cons
       
       //Rcpp::Rcout << std::endl;      
       
+      // path[0] is the most recent common ancestor, the others' edges to their fathers are on the path
+      for (size_t k = 1; k < path.size(); ++k) {
+        mutations += path[k]->get_mutations();
+      }
+      
       if (meiosis_dist == -1) {
         Rcpp::stop("Cannot occur in pedigree!");
       }
@@ -571,18 +583,20 @@ Rcpp::IntegerMatrix pedigree_haplotype_matches_in_pedigree_meiosis_L1_dists(cons
       meiosis_dists.push_back(meiosis_dist);
       max_L1_dists.push_back(max_L1);
       pids.push_back(dest->get_pid());
+      path_mutations.push_back(mutations);
     }
   }
   
   size_t n = meiosis_dists.size();
   
-  Rcpp::IntegerMatrix matches(n, 3);
-  colnames(matches) = Rcpp::CharacterVector::create("meioses", "max_L1", "pid");
+  Rcpp::IntegerMatrix matches(n, 4);
+  colnames(matches) = Rcpp::CharacterVector::create("meioses", "max_L1", "pid", "mutations");
   
   for (size_t i = 0; i < n; ++i) {
     matches(i, 0) = meiosis_dists[i];
     matches(i, 1) = max_L1_dists[i];
     matches(i, 2) = pids[i];
+    matches(i, 3) = path_mutations[i];
   }
   
   return matches;
@@ -0,0 +1,696 @@
+/**
+ api_utility_haplotypes_dist.cpp
+ Purpose: Logic related to pairwise distances between haplotypes.
+ Details: API between R user and C++ logic.
+
+ @author Mikkel Meyer Andersen
+ */
+
+#include <RcppArmadillo.h>
+
+// [[Rcpp::depends(RcppProgress)]]
+// [[Rcpp::depends(RcppArmadillo)]]
+
+#include <progress.hpp>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <unordered_map>
+#include <utility>
+
+#include "malan_types.h"
+
+using namespace Rcpp;
+
+// rows per block: a block of haplotypes is kept in cache while compared to another block
+#define L1_BLOCK_SIZE 64
+
+/*
+Haplotypes packed row by row (haplotype i is at [i*loci, (i+1)*loci)),
+as R's matrices are stored column by column.
+*/
+static std::vector<int> pack_haplotypes(const IntegerMatrix& haplotypes) {
+  size_t n = haplotypes.nrow();
+  size_t loci = haplotypes.ncol();
+  std::vector<int> packed(n * loci);
+
+  for (size_t loc = 0; loc < loci; ++loc) {
+    for (size_t i = 0; i < n; ++i) {
+      int h = haplotypes(i, loc);
+
+      if (h == NA_INTEGER) {
+        Rcpp::stop("haplotypes must not contain NA");
+      }
+
+      packed[i*loci + loc] = h;
+    }
+  }
+
+  return packed;
+}
+
+// branch free, so the loop over loci can be vectorised
+static inline int haplotype_L1(const int* h1, const int* h2, size_t loci) {
+  int d = 0;
+
+  for (size_t loc = 0; loc < loci; ++loc) {
+    d += std::abs(h1[loc] - h2[loc]);
+  }
+
+  return d;
+}
+
+static int threads_to_use(int threads) {
+  if (threads < 0) {
+    Rcpp::stop("threads must be >= 0");
+  }
+
+#ifdef _OPENMP
+  if (threads == 0) {
+    threads = omp_get_max_threads();
+  }
+#else
+  threads = 1;
+#endif
+
+  return threads;
+}
+
+//' Pairwise L1 distances between haplotypes
+//'
+//' Computes the L1 distance (sum of absolute differences over loci) between all pairs of haplotypes,
+//' e.g. from [get_haplotypes_individuals()].
+//' The haplotypes are compared block by block (for cache efficiency), in parallel.
+//' For many haplotypes, where the full matrix is too large, use [haplotypes_L1_pairs()].
+//'
+//' @param haplotypes Integer matrix with a haplotype per row
+//' @param threads Number of threads; 0 means the OpenMP default.
+//'
+//' @return An `n x n` integer matrix with the L1 distances, where `n` is the number of haplotypes
+//'
+//' @seealso [haplotypes_L1_pairs()].
+//'
+//' @export
+// [[Rcpp::export]]
+IntegerMatrix haplotypes_L1_matrix(IntegerMatrix haplotypes, int threads = 0) {
+  threads = threads_to_use(threads);
+
+  size_t n = haplotypes.nrow();
+  size_t loci = haplotypes.ncol();
+  std::vector<int> packed = pack_haplotypes(haplotypes);
+  const int* h = packed.data();
+
+  IntegerMatrix dists(n, n);
+  int* d = &(dists[0]); // column major: (i, j) at [i + j*n]
+
+  int blocks = (n + L1_BLOCK_SIZE - 1) / L1_BLOCK_SIZE;
+  bool aborted = false;
+
+  #pragma omp parallel for schedule(dynamic, 1) num_threads(threads)
+  for (int bi = 0; bi < blocks; ++bi) {
+    if (aborted) {
+      continue;
+    }
+
+    size_t i_begin = (size_t)bi * L1_BLOCK_SIZE;
+    size_t i_end = std::min(i_begin + L1_BLOCK_SIZE, n);
+
+    // each block of rows fills (i, j) and (j, i) for j >= i
+    for (size_t j_begin = i_begin; j_begin < n; j_begin += L1_BLOCK_SIZE) {
+      size_t j_end = std::min(j_begin + L1_BLOCK_SIZE, n);
+
+      for (size_t i = i_begin; i < i_end; ++i) {
+        for (size_t j = std::max(j_begin, i); j < j_end; ++j) {
+          int dij = haplotype_L1(h + i*loci, h + j*loci, loci);
+          d[i + j*n] = dij;
+          d[j + i*n] = dij;
+        }
+      }
+    }
+
+    // only master thread checks
+    if (Progress::check_abort()) {
+      aborted = true;
+    }
+  }
+
+  if (aborted) {
+    Rcpp::stop("Aborted");
+  }
+
+  return dists;
+}
+
+//' Pairs of haplotypes within an L1 distance
+//'
+//' Finds all pairs of haplotypes (e.g. from [get_haplotypes_individuals()])
+//' with L1 distance (sum of absolute differences over loci) at most `max_dist`,
+//' without storing the full distance matrix as [haplotypes_L1_matrix()],
+//' so it can be used for many (e.g. \eqn{10^5}) haplotypes.
+//' The haplotypes are compared block by block (for cache efficiency), in parallel.
+//'
+//' @param haplotypes Integer matrix with a haplotype per row
+//' @param max_dist Largest L1 distance to include
+//' @param threads Number of threads; 0 means the OpenMP default.
+//'
+//' @return A data frame with a row per pair `i < j` (rows in `haplotypes`) with
+//' L1 distance `dist` at most `max_dist`, sorted by `i` and then `j`
+//'
+//' @seealso [haplotypes_L1_matrix()].
+//'
+//' @export
+// [[Rcpp::export]]
+DataFrame haplotypes_L1_pairs(IntegerMatrix haplotypes, int max_dist = 0, int threads = 0) {
+  if (max_dist < 0) {
+    Rcpp::stop("max_dist must be >= 0");
+  }
+
+  threads = threads_to_use(threads);
+
+  size_t n = haplotypes.nrow();
+  size_t loci = haplotypes.ncol();
+  std::vector<int> packed = pack_haplotypes(haplotypes);
+  const int* h = packed.data();
+
+  int blocks = (n + L1_BLOCK_SIZE - 1) / L1_BLOCK_SIZE;
+
+  // pairs found from each block of rows, so the result does not depend on the threads
+  std::vector< std::vector<int> > block_pairs(blocks); // i, j, dist, i, j, dist, ...
+  bool aborted = false;
+
+  #pragma omp parallel for schedule(dynamic, 1) num_threads(threads)
+  for (int bi = 0; bi < blocks; ++bi) {
+    if (aborted) {
+      continue;
+    }
+
+    size_t i_begin = (size_t)bi * L1_BLOCK_SIZE;
+    size_t i_end = std::min(i_begin + L1_BLOCK_SIZE, n);
+    std::vector<int>& pairs = block_pairs[bi];
+
+    for (size_t j_begin = i_begin; j_begin < n; j_begin += L1_BLOCK_SIZE) {
+      size_t j_end = std::min(j_begin + L1_BLOCK_SIZE, n);
+
+      for (size_t i = i_begin; i < i_end; ++i) {
+        for (size_t j = std::max(j_begin, i + 1); j < j_end; ++j) {
+          int dij = haplotype_L1(h + i*loci, h + j*loci, loci);
+
+          if (dij <= max_dist) {
+            pairs.push_back(i);
+            pairs.push_back(j);
+            pairs.push_back(dij);
+          }
+        }
+      }
+    }
+
+    // by i, then j (found by j block within i)
+    size_t found = pairs.size() / 3;
+    std::vector<size_t> order(found);
+
+    for (size_t k = 0; k < found; ++k) {
+      order[k] = k;
+    }
+
+    std::sort(order.begin(), order.end(), [&pairs](size_t a, size_t b) {
+      return (pairs[3*a] != pairs[3*b]) ? (pairs[3*a] < pairs[3*b]) : (pairs[3*a + 1] < pairs[3*b + 1]);
+    });
+
+    std::vector<int> sorted_pairs(pairs.size());
+
+    for (size_t k = 0; k < found; ++k) {
+      std::copy(pairs.begin() + 3*order[k], pairs.begin() + 3*order[k] + 3, sorted_pairs.begin() + 3*k);
+    }
+
+    pairs.swap(sorted_pairs);
+
+    // only master thread checks
+    if (Progress::check_abort()) {
+      aborted = true;
+    }
+  }
+
+  if (aborted) {
+    Rcpp::stop("Aborted");
+  }
+
+  size_t found = 0;
+
+  for (auto& pairs : block_pairs) {
+    found += pairs.size() / 3;
+  }
+
+  IntegerVector res_i(found);
+  IntegerVector res_j(found);
+  IntegerVector res_dist(found);
+  size_t k = 0;
+
+  for (auto& pairs : block_pairs) {
+    for (size_t p = 0; p < pairs.size(); p += 3) {
+      res_i[k] = pairs[p] + 1;
+      res_j[k] = pairs[p + 1] + 1;
+      res_dist[k] = pairs[p + 2];
+      k += 1;
+    }
+  }
+
+  return DataFrame::create(
+    Named("i") = res_i,
+    Named("j") = res_j,
+    Named("dist") = res_dist);
+}
+
+/*
+Haplotypes of the individuals in index in generations 0, 1, ..., generations - 1 packed 
+(individual i's haplotype is at haplotype_offset[i], -1 for those not included).
+Returns the number of loci.
+*/
+static size_t pack_pedigree_haplotypes(const PedigreeIndex& index, int generations, 
+                                       std::vector<int>& haplotype_offset, std::vector<int>& haplotypes) {
+  int n = index.size();
+  haplotype_offset.assign(n, -1);
+  haplotypes.clear();
+  
+  size_t loci = 0;
+  bool loci_set = false;
+
+  for (int i = 0; i < n; ++i) {
+    if (index.get_generation(i) >= generations) {
+      continue;
+    }
+
+    Individual* indv = index.get_individual(i);
+
+    if (!indv->is_haplotype_set()) {
+      Rcpp::stop("Haplotypes not yet populated");
+    }
+
+    std::vector<int> h = indv->get_haplotype();
+
+    if (!loci_set) {
+      loci = h.size();
+      loci_set = true;
+    } else if (h.size() != loci) {
+      Rcpp::stop("Haplotypes do not have the same number of loci");
+    }
+
+    haplotype_offset[i] = haplotypes.size();
+    haplotypes.insert(haplotypes.end(), h.begin(), h.end());
+  }
+  
+  return loci;
+}
+
+// (meioses << 32 | L1, generation_1 << 32 | generation_2)
+typedef std::pair<uint64_t, uint64_t> MeiosesL1Bin;
+
+struct MeiosesL1BinHash {
+  size_t operator()(const MeiosesL1Bin& x) const {
+    uint64_t h = x.first * 0x9e3779b97f4a7c15ULL + x.second;
+    return h ^ (h >> 29);
+  }
+};
+
+// sparse: only the bins that occur (there are few compared to all combinations of generations)
+typedef std::unordered_map<MeiosesL1Bin, double, MeiosesL1BinHash> MeiosesL1Histogram;
+
+//' Joint distribution of meioses and L1 distances between pairs in pedigrees
+//'
+//' For every pair of individuals in the same pedigree (in generations
+//' 0, 1, ..., `generation_upper_bound_in_result`), the number of meioses between them
+//' and the L1 distance between their haplotypes (0 for a match) are computed, 
+//' and the pairs are counted by (meioses, L1 distance, generations) without returning the pairs.
+//'
+//' Pedigrees are done in parallel. Within a pedigree, the individuals are ordered depth first,
+//' as then the most recent common ancestor of two individuals is the shallowest of the most recent 
+//' common ancestors of the neighbours between them, so the number of meioses of a pair 
+//' takes constant time (and no search in the pedigree).
+//'
+//' Note, that pedigrees must first have been inferred by [build_pedigrees()] and
+//' haplotypes populated (e.g. by [pedigrees_all_populate_haplotypes()]).
+//'
+//' @param pedigrees Pedigree list
+//' @param generation_upper_bound_in_result Only consider individuals in 
+//' generation 0, 1, ... generation_upper_bound_in_result.
+//' -1 means disabled, consider all generations.
+//' End generation is generation 0.
+//' @param threads Number of threads; 0 means the OpenMP default.
+//' @param progress Show progress
+//'
+//' @return A data frame with a row per combination of `meioses`, `L1` (L1 distance), 
+//' `generation_1` and `generation_2` (the generations of the two individuals, `generation_1 <= generation_2`)
+//' with the number of pairs (`pairs`), sorted by the four
+//'
+//' @seealso [pedigree_haplotype_matches_in_pedigree_meiosis_L1_dists()] and [haplotypes_L1_pairs()].
+//'
+//' @export
+// [[Rcpp::export]]
+DataFrame pedigrees_meioses_L1_table(Rcpp::XPtr< std::vector<Pedigree*> > pedigrees,
+                                     int generation_upper_bound_in_result = -1,
+                                     int threads = 0,
+                                     bool progress = true) {
+
+  if (generation_upper_bound_in_result < -1) {
+    Rcpp::stop("generation_upper_bound_in_result must be -1 or >= 0");
+  }
+
+  threads = threads_to_use(threads);
+
+  // built on the main thread as Pedigree::get_root() may call R
+  PedigreeIndex index(*pedigrees);
+  int n = index.size();
+
+  // individuals in the result and their (packed) haplotypes
+  int generation_max = 0;
+
+  for (int i = 0; i < n; ++i) {
+    generation_max = std::max(generation_max, index.get_generation(i));
+  }
+
+  int generations = (generation_upper_bound_in_result == -1) ? 
+    generation_max + 1 : 
+    std::min(generation_upper_bound_in_result, generation_max) + 1;
+
+  std::vector<int> haplotype_offset;
+  std::vector<int> haplotypes;
+  size_t loci = pack_pedigree_haplotypes(index, generations, haplotype_offset, haplotypes);
+
+  MeiosesL1Histogram histogram;
+
+  int pedigrees_count = index.get_pedigrees_count();
+  Progress progress_bar(pedigrees_count, progress);
+  bool aborted = false;
+
+  #pragma omp parallel num_threads(threads)
+  {
+    MeiosesL1Histogram histogram_thread;
+    
+    // per pedigree, indices local to the pedigree
+    std::vector<int> depth;
+    std::vector<int> first_child;
+    std::vector<int> next_brother;
+    std::vector<int> stack;
+    std::vector<int> in_result; // depth first order
+    std::vector<int> lca_depth; // of in_result[k - 1] and in_result[k]
+
+    #pragma omp for schedule(dynamic, 1)
+    for (int p = 0; p < pedigrees_count; ++p) {
+      if (aborted) {
+        continue;
+      }
+
+      int begin = index.get_pedigree_begin(p);
+      int m = index.get_pedigree_end(p) - begin;
+
+      // fathers come before sons (breadth first)
+      depth.assign(m, 0);
+      first_child.assign(m, -1);
+      next_brother.assign(m, -1);
+
+      for (int i = m - 1; i >= 1; --i) {
+        int f = index.get_father(begin + i) - begin;
+        next_brother[i] = first_child[f];
+        first_child[f] = i;
+      }
+
+      for (int i = 1; i < m; ++i) {
+        depth[i] = depth[index.get_father(begin + i) - begin] + 1;
+      }
+
+      // depth first order of those in the result
+      in_result.clear();
+      stack.assign(1, 0);
+
+      while (!stack.empty()) {
+        int i = stack.back();
+        stack.pop_back();
+
+        if (haplotype_offset[begin + i] != -1) {
+          in_result.push_back(i);
+        }
+
+        for (int c = first_child[i]; c != -1; c = next_brother[c]) {
+          stack.push_back(c);
+        }
+      }
+
+      // most recent common ancestors of neighbours
+      size_t l = in_result.size();
+      lca_depth.assign(l, 0);
+
+      for (size_t k = 1; k < l; ++k) {
+        int u = in_result[k - 1];
+        int v = in_result[k];
+
+        while (u != v) {
+          if (depth[u] >= depth[v]) {
+            u = index.get_father(begin + u) - begin;
+          } else {
+            v = index.get_father(begin + v) - begin;
+          }
+        }
+
+        lca_depth[k] = depth[u];
+      }
+
+      for (size_t a = 0; a < l; ++a) {
+        int i = in_result[a];
+        const int* h_i = haplotypes.data() + haplotype_offset[begin + i];
+        int generation_i = index.get_generation(begin + i);
+        int lca = depth[i];
+
+        for (size_t b = a + 1; b < l; ++b) {
+          int j = in_result[b];
+          lca = std::min(lca, lca_depth[b]);
+
+          uint64_t meioses = depth[i] + depth[j] - 2*lca;
+          uint64_t L1 = haplotype_L1(h_i, haplotypes.data() + haplotype_offset[begin + j], loci);
+          int generation_j = index.get_generation(begin + j);
+          uint64_t g1 = std::min(generation_i, generation_j);
+          uint64_t g2 = std::max(generation_i, generation_j);
+
+          histogram_thread[std::make_pair((meioses << 32) | L1, (g1 << 32) | g2)] += 1.0;
+        }
+      }
+
+      // only master thread checks (and the progress bar is thread safe)
+      if (Progress::check_abort()) {
+        aborted = true;
+      }
+
+      if (progress) {
+        progress_bar.increment();
+      }
+    }
+
+    #pragma omp critical
+    {
+      for (auto& bin : histogram_thread) {
+        histogram[bin.first] += bin.second;
+      }
+    }
+  }
+
+  if (aborted) {
+    Rcpp::stop("Aborted");
+  }
+
+  std::vector<int> res_meioses;
+  std::vector<int> res_L1;
+  std::vector<int> res_generation_1;
+  std::vector<int> res_generation_2;
+  std::vector<double> res_pairs;
+  std::vector< std::pair<MeiosesL1Bin, double> > bins(histogram.begin(), histogram.end());
+
+  // by meioses, L1 and then generations
+  std::sort(bins.begin(), bins.end());
+
+  for (auto& bin : bins) {
+    res_meioses.push_back(bin.first.first >> 32);
+    res_L1.push_back(bin.first.first & 0xFFFFFFFF);
+    res_generation_1.push_back(bin.first.second >> 32);
+    res_generation_2.push_back(bin.first.second & 0xFFFFFFFF);
+    res_pairs.push_back(bin.second);
+  }
+
+  return DataFrame::create(
+    Named("meioses") = res_meioses,
+    Named("L1") = res_L1,
+    Named("generation_1") = res_generation_1,
+    Named("generation_2") = res_generation_2,
+    Named("pairs") = res_pairs);
+}
+
+//' Classify haplotype matches in pedigrees as identical by descent or by state
+//'
+//' Finds all pairs of individuals in the same pedigree (in generations
+//' 0, 1, ..., `generation_upper_bound_in_result`) with the same haplotype, and for each the number of
+//' mutations on the path between them: if there are none, the haplotypes are identical by descent (IBD), 
+//' else only by state (IBS; the mutations cancel out).
+//'
+//' The mutations on the edge from each individual's father are recorded when haplotypes are
+//' populated (e.g. by [pedigrees_all_populate_haplotypes()] or [population_populate_haplotypes()]),
+//' and summed from the root of the pedigree, 
+//' so the mutations on the path between two individuals is found from their most recent common ancestor.
+//' Pedigrees are done in parallel.
+//'
+//' Note, that pedigrees must first have been inferred by [build_pedigrees()] and
+//' haplotypes populated.
+//'
+//' @param pedigrees Pedigree list
+//' @param generation_upper_bound_in_result Only consider individuals in 
+//' generation 0, 1, ... generation_upper_bound_in_result.
+//' -1 means disabled, consider all generations.
+//' End generation is generation 0.
+//' @param threads Number of threads; 0 means the OpenMP default.
+//' @param progress Show progress
+//'
+//' @return A data frame with a row per matching pair with `pid_1`, `pid_2`, 
+//' `meioses` (between them), `mutations` (on the path between them) and `ibd` (`mutations == 0`)
+//'
+//' @seealso [pedigree_haplotype_matches_in_pedigree_meiosis_L1_dists()] and [pedigrees_meioses_L1_table()].
+//'
+//' @export
+// [[Rcpp::export]]
+DataFrame pedigrees_haplotype_matches_ibd(Rcpp::XPtr< std::vector<Pedigree*> > pedigrees,
+                                          int generation_upper_bound_in_result = -1,
+                                          int threads = 0,
+                                          bool progress = true) {
+
+  if (generation_upper_bound_in_result < -1) {
+    Rcpp::stop("generation_upper_bound_in_result must be -1 or >= 0");
+  }
+
+  threads = threads_to_use(threads);
+
+  // built on the main thread as Pedigree::get_root() may call R
+  PedigreeIndex index(*pedigrees);
+  int n = index.size();
+  int generations = (generation_upper_bound_in_result == -1) ? INT_MAX : generation_upper_bound_in_result + 1;
+
+  std::vector<int> haplotype_offset;
+  std::vector<int> haplotypes;
+  size_t loci = pack_pedigree_haplotypes(index, generations, haplotype_offset, haplotypes);
+
+  // fathers come before sons: depth and mutations from the root
+  std::vector<int> depth(n, 0);
+  std::vector<int> mutations_from_root(n, 0);
+
+  for (int i = 0; i < n; ++i) {
+    int f = index.get_father(i);
+
+    if (f != -1) {
+      depth[i] = depth[f] + 1;
+      mutations_from_root[i] = mutations_from_root[f] + index.get_individual(i)->get_mutations();
+    }
+  }
+
+  int pedigrees_count = index.get_pedigrees_count();
+  std::vector< std::vector<int> > pedigree_matches(pedigrees_count); // i, j, lca, i, j, lca, ...
+  Progress progress_bar(pedigrees_count, progress);
+  bool aborted = false;
+
+  #pragma omp parallel num_threads(threads)
+  {
+    std::vector<int> in_result;
+
+    #pragma omp for schedule(dynamic, 1)
+    for (int p = 0; p < pedigrees_count; ++p) {
+      if (aborted) {
+        continue;
+      }
+
+      in_result.clear();
+
+      for (int i = index.get_pedigree_begin(p); i < index.get_pedigree_end(p); ++i) {
+        if (haplotype_offset[i] != -1) {
+          in_result.push_back(i);
+        }
+      }
+
+      // equal haplotypes next to each other
+      auto hap = [&](int i) { return haplotypes.data() + haplotype_offset[i]; };
+      std::stable_sort(in_result.begin(), in_result.end(), [&](int a, int b) {
+        return std::lexicographical_compare(hap(a), hap(a) + loci, hap(b), hap(b) + loci);
+      });
+
+      std::vector<int>& matches = pedigree_matches[p];
+      size_t run_begin = 0;
+
+      for (size_t k = 1; k <= in_result.size(); ++k) {
+        if (k < in_result.size() && std::equal(hap(in_result[k]), hap(in_result[k]) + loci, hap(in_result[run_begin]))) {
+          continue;
+        }
+
+        // in_result[run_begin], ..., in_result[k - 1] match
+        for (size_t a = run_begin; a < k; ++a) {
+          for (size_t b = a + 1; b < k; ++b) {
+            int u = in_result[a];
+            int v = in_result[b];
+
+            while (u != v) {
+              if (depth[u] >= depth[v]) {
+                u = index.get_father(u);
+              } else {
+                v = index.get_father(v);
+              }
+            }
+
+            matches.push_back(std::min(in_result[a], in_result[b]));
+            matches.push_back(std::max(in_result[a], in_result[b]));
+            matches.push_back(u);
+          }
+        }
+
+        run_begin = k;
+      }
+
+      // only master thread checks (and the progress bar is thread safe)
+      if (Progress::check_abort()) {
+        aborted = true;
+      }
+
+      if (progress) {
+        progress_bar.increment();
+      }
+    }
+  }
+
+  if (aborted) {
+    Rcpp::stop("Aborted");
+  }
+
+  std::vector<int> res_pid_1;
+  std::vector<int> res_pid_2;
+  std::vector<int> res_meioses;
+  std::vector<int> res_mutations;
+  std::vector<bool> res_ibd;
+
+  for (auto& matches : pedigree_matches) {
+    for (size_t k = 0; k < matches.size(); k += 3) {
+      int i = matches[k];
+      int j = matches[k + 1];
+      int lca = matches[k + 2];
+      int mutations = mutations_from_root[i] + mutations_from_root[j] - 2*mutations_from_root[lca];
+
+      res_pid_1.push_back(index.get_individual(i)->get_pid());
+      res_pid_2.push_back(index.get_individual(j)->get_pid());
+      res_meioses.push_back(depth[i] + depth[j] - 2*depth[lca]);
+      res_mutations.push_back(mutations);
+      res_ibd.push_back(mutations == 0);
+    }
+  }
+
+  return DataFrame::create(
+    Named("pid_1") = res_pid_1,
+    Named("pid_2") = res_pid_2,
+    Named("meioses") = res_meioses,
+    Named("mutations") = res_mutations,
+    Named("ibd") = res_ibd);
+}
+
@@ -0,0 +1,247 @@
+/**
+ api_utility_haplotypes_generations.cpp
+ Purpose: Logic to populate haplotypes generation by generation.
+ Details: API between R user and C++ logic.
+
+ @author Mikkel Meyer Andersen
+ */
+
+#include <RcppArmadillo.h>
+
+// [[Rcpp::depends(RcppProgress)]]
+// [[Rcpp::depends(RcppArmadillo)]]
+
+#include <progress.hpp>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "malan_types.h"
+
+using namespace Rcpp;
+
+// individuals per random number stream (and per task)
+#define SWEEP_BLOCK_SIZE 1024
+
+/*
+Mutate the haplotypes of n sons from their fathers' haplotypes,
+as Individual::haplotype_mutate() but with one uniform per locus:
+given u < mutation rate, u / mutation rate is uniform,
+so the step is down if u < mutation rate / 2 and up otherwise.
+No branches, so the loop over loci can be vectorised.
+*/
+static void sweep_mutate_block(int* haplotypes, const int* fathers_haplotypes, const int* fathers, size_t n,
+                               const std::vector<double>& mutation_rates, const std::vector<double>& mutation_rates_half,
+                               std::vector<double>& u, StreamRNG& rng) {
+  size_t loci = mutation_rates.size();
+
+  u.resize(n * loci);
+  rng.unif_rand_fill(u.data(), n * loci);
+
+  const double* mu = mutation_rates.data();
+  const double* mu_half = mutation_rates_half.data();
+
+  for (size_t k = 0; k < n; ++k) {
+    int* h = haplotypes + k*loci;
+    const int* h_father = fathers_haplotypes + (size_t)fathers[k]*loci;
+    const double* u_k = u.data() + k*loci;
+
+    for (size_t loc = 0; loc < loci; ++loc) {
+      int down = (u_k[loc] < mu_half[loc]);
+      int up = (u_k[loc] < mu[loc]) - down;
+      h[loc] = h_father[loc] - down + up;
+    }
+  }
+}
+
+//' Populate haplotypes in a population generation by generation
+//'
+//' Populates haplotypes in all individuals in the population, as
+//' [pedigrees_all_populate_haplotypes()] does, but without pedigrees (and without building them first):
+//' individuals without a father (founders) get haplotype `rep(0L, length(mutation_rates))`, and
+//' the generations are processed from the oldest to the youngest,
+//' where each son gets his father's haplotype with mutations
+//' (at each locus, with probability given by `mutation_rates`, one step up or down
+//' with equal probability).
+//'
+//' Each generation is stored as a flat array (of haplotypes and of
+//' the fathers' positions in the previous generation), so there is no tree traversal, and
+//' a generation is processed in parallel in blocks of individuals.
+//' Only two generations' haplotypes are kept besides those of the individuals.
+//'
+//' Each block uses its own random number stream derived from `seed`,
+//' so results only depend on `seed` and not on the number of threads
+//' (but differ from [pedigrees_all_populate_haplotypes()] after the same `set.seed()`).
+//'
+//' Note, that a father must be exactly one generation older than his sons,
+//' as in populations simulated by e.g. [sample_geneology()].
+//'
+//' @param population Population
+//' @param mutation_rates Vector with mutation rates, length `loci`
+//' @param seed Seed for the random number streams; `NA` means draw from R's random number generator.
+//' @param threads Number of threads; 0 means the OpenMP default.
+//' @param progress Show progress
+//'
+//' @seealso [pedigrees_all_populate_haplotypes()].
+//'
+//' @export
+// [[Rcpp::export]]
+void population_populate_haplotypes(Rcpp::XPtr<Population> population,
+                                    Rcpp::NumericVector mutation_rates,
+                                    int seed = NA_INTEGER,
+                                    int threads = 0,
+                                    bool progress = true) {
+
+  std::vector<double> mut_rates = Rcpp::as< std::vector<double> >(mutation_rates);
+  size_t loci = mut_rates.size();
+
+  if (loci == 0) {
+    Rcpp::stop("mutation_rates must have at least one locus");
+  }
+
+  if (threads < 0) {
+    Rcpp::stop("threads must be >= 0");
+  }
+
+#ifdef _OPENMP
+  if (threads == 0) {
+    threads = omp_get_max_threads();
+  }
+#else
+  threads = 1;
+#endif
+
+  std::vector<double> mut_rates_half(loci);
+
+  for (size_t loc = 0; loc < loci; ++loc) {
+    mut_rates_half[loc] = 0.5*mut_rates[loc];
+  }
+
+  std::unordered_map<int, Individual*>* population_map = population->get_population();
+
+  // founders by generation
+  int generation_max = -1;
+
+  for (auto it = population_map->begin(); it != population_map->end(); ++it) {
+    if (it->second->get_generation() < 0) {
+      Rcpp::stop("Individual with pid = " + std::to_string(it->first) + " has no generation");
+    }
+
+    generation_max = std::max(generation_max, it->second->get_generation());
+  }
+
+  std::vector< std::vector<Individual*> > founders(generation_max + 1);
+
+  for (auto it = population_map->begin(); it != population_map->end(); ++it) {
+    if (it->second->get_father() == nullptr) {
+      founders[it->second->get_generation()].push_back(it->second);
+    }
+  }
+
+  uint64_t base_seed = (seed == NA_INTEGER) ? draw_seed_from_R() : (uint64_t)seed;
+  size_t individuals_done = 0;
+
+  // generation g: individuals (founders first, then sons by father) and
+  // their fathers' positions in generation g + 1
+  std::vector<Individual*> fathers_generation;
+  std::vector<Individual*> children_generation;
+  std::vector<int> children_fathers;
+  std::vector<int> fathers_haplotypes;
+  std::vector<int> children_haplotypes;
+
+  Progress progress_bar(generation_max + 1, progress);
+
+  for (int generation = generation_max; generation >= 0; --generation) {
+    children_generation.clear();
+    children_fathers.clear();
+
+    for (auto founder : founders[generation]) {
+      children_generation.push_back(founder);
+    }
+
+    size_t founders_count = children_generation.size();
+
+    for (size_t k = 0; k < fathers_generation.size(); ++k) {
+      for (auto child : fathers_generation[k]->get_children()) {
+        if (child->get_generation() != generation) {
+          Rcpp::stop("Individual with pid = " + std::to_string(child->get_pid()) +
+                     " is not exactly one generation younger than his father");
+        }
+
+        children_generation.push_back(child);
+        children_fathers.push_back(k);
+      }
+    }
+
+    size_t n = children_generation.size();
+    size_t sons = n - founders_count;
+    children_haplotypes.resize(n * loci);
+    std::fill(children_haplotypes.begin(), children_haplotypes.begin() + founders_count*loci, 0);
+
+    int blocks = (sons + SWEEP_BLOCK_SIZE - 1) / SWEEP_BLOCK_SIZE;
+    bool aborted = false;
+
+    #pragma omp parallel num_threads(threads)
+    {
+      std::vector<double> u; // per thread
+
+      #pragma omp for schedule(dynamic, 1)
+      for (int b = 0; b < blocks; ++b) {
+        if (aborted) {
+          continue;
+        }
+
+        size_t begin = (size_t)b * SWEEP_BLOCK_SIZE;
+        size_t end = std::min(begin + SWEEP_BLOCK_SIZE, sons);
+        // a stream per (generation, block), seeded in O(1)
+        StreamRNG rng(base_seed, ((uint64_t)generation << 32) | (uint64_t)b);
+
+        sweep_mutate_block(children_haplotypes.data() + (founders_count + begin)*loci,
+                           fathers_haplotypes.data(), children_fathers.data() + begin, end - begin,
+                           mut_rates, mut_rates_half, u, rng);
+
+        // only master thread checks
+        if (Progress::check_abort()) {
+          aborted = true;
+        }
+      }
+
+      #pragma omp for schedule(static)
+      for (size_t i = 0; i < n; ++i) {
+        const int* h = children_haplotypes.data() + i*loci;
+        children_generation[i]->set_haplotype(std::vector<int>(h, h + loci));
+        
+        // a mutation always changes the locus (one step)
+        if (i >= founders_count) {
+          const int* h_father = fathers_haplotypes.data() + (size_t)children_fathers[i - founders_count]*loci;
+          int mutations = 0;
+          
+          for (size_t loc = 0; loc < loci; ++loc) {
+            mutations += (h[loc] != h_father[loc]);
+          }
+          
+          children_generation[i]->set_mutations(mutations);
+        }
+      }
+    }
+
+    if (aborted) {
+      Rcpp::stop("Aborted");
+    }
+
+    individuals_done += n;
+
+    fathers_generation.swap(children_generation);
+    fathers_haplotypes.swap(children_haplotypes);
+
+    if (progress) {
+      progress_bar.increment();
+    }
+  }
+
+  if (individuals_done != population_map->size()) {
+    Rcpp::stop("Not all individuals were reached from a founder: a father must be exactly one generation older than his sons");
+  }
+}
+
@@ -49,19 +49,17 @@ void print_individual(Rcpp::XPtr<Individual> individual) {
   Individual* i = individual;
   
   int pid_f = (i->get_father() != nullptr) ? i->get_father()->get_pid() : -1;
-  std::vector<Individual*>* children = i->get_children();
+  IndividualChildren children = i->get_children();
   
   Rcpp::Rcout << "  pid = " << i->get_pid() << " with father pid = " << pid_f << " and";
   
-  if (children->size() == 0) {
+  if (children.size() == 0) {
     Rcpp::Rcout << " no children" << std::endl;
   } else {
-    Rcpp::Rcout << " children (n = " << children->size() << "): " << std::endl;
+    Rcpp::Rcout << " children (n = " << children.size() << "): " << std::endl;
 
-    for (auto child : *children) {    
-      std::vector<Individual*>* child_children = child->get_children();
-      
-      Rcpp::Rcout << "    pid = " << child->get_pid() << " with father pid = " << pid_f << " and " <<  child_children->size() << " children" << std::endl;
+    for (auto child : children) {    
+      Rcpp::Rcout << "    pid = " << child->get_pid() << " with father pid = " << pid_f << " and " <<  child->get_children_count() << " children" << std::endl;
     }
   }
 }
@@ -81,6 +79,21 @@ int get_generation(Rcpp::XPtr<Individual> individual) {
   return individual->get_generation();
 }
 
+//' Get individual's deme
+//' 
+//' Individuals simulated by [sample_geneology_demes()] belong to 
+//' deme 1, 2, ..., D; all other individuals belong to deme 1.
+//' 
+//' @param individual Individual
+//' 
+//' @return deme
+//' 
+//' @export
+// [[Rcpp::export]]
+int get_deme(Rcpp::XPtr<Individual> individual) {  
+  return individual->get_deme() + 1;
+}
+
 //' Get pedigree from individual
 //' 
 //' @param individual Individual
@@ -124,6 +137,32 @@ Rcpp::IntegerVector get_pedigree_id_from_pid(Rcpp::XPtr<Population> population,
 
 
 
+//' Get demes from pids
+//' 
+//' E.g. `split(pids, get_deme_from_pid(population, pids))` gives 
+//' subpopulations for [estimate_theta_subpops_pids()].
+//'
+//' @param population Population
+//' @param pids Pids
+//' 
+//' @return Vector with demes (see [get_deme()])
+//' 
+//' @export
+// [[Rcpp::export]]
+Rcpp::IntegerVector get_deme_from_pid(Rcpp::XPtr<Population> population, 
+                                      Rcpp::IntegerVector pids) {  
+  int N = pids.size();
+  Rcpp::IntegerVector demes(N);
+  
+  for (int i = 0; i < N; ++i) {
+    Individual* ind = population->get_individual(pids[i]);
+    demes[i] = ind->get_deme() + 1;
+  }
+  
+  return demes;
+}
+
+
 //////////////////////////////////////
 
 //' Get individual's family information
@@ -157,11 +196,9 @@ Rcpp::List get_family_info(Rcpp::XPtr<Individual> individual) {
 //' @export
 // [[Rcpp::export]]
 Rcpp::List get_children(Rcpp::XPtr<Individual> individual) {  
-  std::vector<Individual*>* individuals_boys = individual->get_children();
-  
   Rcpp::List children;
   
-  for (auto child : *individuals_boys) {
+  for (auto child : individual->get_children()) {
     Rcpp::XPtr<Individual> child_xptr(child, RCPP_XPTR_2ND_ARG); // do NOT delete individual when not used any more, it still exists in pedigree and population etc.!
     child_xptr.attr("class") = Rcpp::CharacterVector::create("malan_individual", "externalptr");
   
@@ -218,11 +255,9 @@ Rcpp::List get_brothers(Rcpp::XPtr<Individual> individual) {
   
   Individual* father = i->get_father();
   
-  std::vector<Individual*>* father_boys = father->get_children();
-  
   Rcpp::List brothers;
   
-  for (auto brother : *father_boys) {
+  for (auto brother : father->get_children()) {
     if (brother->get_pid() == individual->get_pid()) {
       continue; // exclude individual itself as a brother
     }
@@ -261,15 +296,15 @@ int brothers_matching(Rcpp::XPtr<Individual> individual) {
   std::vector<int> h = i->get_haplotype();  
   int loci = h.size();  
   
-  std::vector<Individual*>* brothers = i->get_father()->get_children();
+  IndividualChildren brothers = i->get_father()->get_children();
   
-  if (brothers->size() == 0) {
+  if (brothers.size() == 0) {
     return 0;
   }
   
   int matching = 0;
 
-  for (auto brother : *brothers) {
+  for (auto brother : brothers) {
     if (brother->get_pid() == i->get_pid()) {
       continue;
     }
@@ -425,11 +460,9 @@ Rcpp::List get_uncles(Rcpp::XPtr<Individual> individual) {
 
   Individual* grandfather = father->get_father();
 
-  std::vector<Individual*>* grandfather_boys = grandfather->get_children();
-  
   Rcpp::List uncles;
   
-  for (auto uncle : *grandfather_boys) {
+  for (auto uncle : grandfather->get_children()) {
     if (uncle->get_pid() == father->get_pid()) {
       continue; // exclude father as uncle
     }
@@ -0,0 +1,390 @@
+/**
+ api_utility_loci_selection.cpp
+ Purpose: Logic to select subsets of loci with high discriminatory power.
+ Details: API between R user and C++ logic.
+
+ @author Mikkel Meyer Andersen
+ */
+
+#include <RcppArmadillo.h>
+
+// [[Rcpp::depends(RcppProgress)]]
+// [[Rcpp::depends(RcppArmadillo)]]
+
+#include <progress.hpp>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <algorithm>
+#include <set>
+
+#include "malan_types.h"
+
+using namespace Rcpp;
+
+/*
+A subset of loci and the partition of the haplotypes it gives:
+order[group_begin[g], group_begin[g + 1]) are the haplotypes in group g
+(those with the same alleles at the loci).
+*/
+struct LociSubset {
+  std::vector<int> loci;
+  std::vector<int> order;
+  std::vector<int> group_begin;
+  double matching_pairs;
+
+  size_t distinct() const {
+    return group_begin.size() - 1;
+  }
+};
+
+/*
+Adding a locus to a subset: candidate c is subset c / loci with locus c % loci.
+*/
+struct LociCandidate {
+  size_t subset;
+  int locus;
+  size_t distinct;
+  double matching_pairs;
+  std::vector<int> loci; // sorted, with locus
+};
+
+/*
+The alleles at each locus recoded as 0, 1, ..., alleles - 1
+(column by column, as R's matrices), so groups can be split by counting.
+*/
+static std::vector<int> recode_alleles(const IntegerMatrix& haplotypes, int* max_alleles) {
+  size_t n = haplotypes.nrow();
+  size_t loci = haplotypes.ncol();
+  std::vector<int> codes(n * loci);
+  std::vector<int> values(n);
+  *max_alleles = 0;
+
+  for (size_t loc = 0; loc < loci; ++loc) {
+    for (size_t i = 0; i < n; ++i) {
+      values[i] = haplotypes(i, loc);
+
+      if (values[i] == NA_INTEGER) {
+        Rcpp::stop("haplotypes must not contain NA");
+      }
+    }
+
+    std::vector<int> alleles(values);
+    std::sort(alleles.begin(), alleles.end());
+    alleles.erase(std::unique(alleles.begin(), alleles.end()), alleles.end());
+    *max_alleles = std::max(*max_alleles, (int)alleles.size());
+
+    for (size_t i = 0; i < n; ++i) {
+      codes[loc*n + i] = std::lower_bound(alleles.begin(), alleles.end(), values[i]) - alleles.begin();
+    }
+  }
+
+  return codes;
+}
+
+/*
+The number of groups and matching pairs after refining the groups of subset by the alleles in codes
+(of a locus) in O(n); count must be zero (and is left so), touched is workspace.
+*/
+static void evaluate_refinement(const LociSubset& subset, const int* codes,
+                                std::vector<int>& count, std::vector<int>& touched,
+                                size_t* distinct, double* matching_pairs) {
+  *distinct = 0;
+  *matching_pairs = 0.0;
+
+  for (size_t g = 0; g < subset.distinct(); ++g) {
+    for (int k = subset.group_begin[g]; k < subset.group_begin[g + 1]; ++k) {
+      int a = codes[subset.order[k]];
+
+      if (count[a]++ == 0) {
+        touched.push_back(a);
+      }
+    }
+
+    for (auto a : touched) {
+      double c = (double)count[a];
+      *distinct += 1;
+      *matching_pairs += 0.5*c*(c - 1.0);
+      count[a] = 0;
+    }
+
+    touched.clear();
+  }
+}
+
+// subset with locus added: each group is split by counting sort on the alleles
+static LociSubset refine(const LociSubset& subset, int locus, const int* codes, int max_alleles) {
+  LociSubset res;
+  res.loci = subset.loci;
+  res.loci.push_back(locus);
+  res.order.resize(subset.order.size());
+  res.group_begin.push_back(0);
+  res.matching_pairs = 0.0;
+
+  std::vector<int> count(max_alleles, 0);
+  std::vector<int> touched;
+
+  for (size_t g = 0; g < subset.distinct(); ++g) {
+    int begin = subset.group_begin[g];
+    int end = subset.group_begin[g + 1];
+
+    for (int k = begin; k < end; ++k) {
+      int a = codes[subset.order[k]];
+
+      if (count[a]++ == 0) {
+        touched.push_back(a);
+      }
+    }
+
+    // count becomes the position of the next haplotype with the allele
+    int pos = begin;
+
+    for (auto a : touched) {
+      double c = (double)count[a];
+      res.matching_pairs += 0.5*c*(c - 1.0);
+
+      count[a] = pos;
+      pos += (int)c;
+      res.group_begin.push_back(pos);
+    }
+
+    for (int k = begin; k < end; ++k) {
+      int i = subset.order[k];
+      res.order[count[codes[i]]++] = i;
+    }
+
+    for (auto a : touched) {
+      count[a] = 0;
+    }
+
+    touched.clear();
+  }
+
+  return res;
+}
+
+// is candidate a better than b
+static bool candidate_better(const LociCandidate& a, const LociCandidate& b, bool by_distinct) {
+  if (by_distinct) {
+    if (a.distinct != b.distinct) {
+      return a.distinct > b.distinct;
+    }
+
+    if (a.matching_pairs != b.matching_pairs) {
+      return a.matching_pairs < b.matching_pairs;
+    }
+  } else {
+    if (a.matching_pairs != b.matching_pairs) {
+      return a.matching_pairs < b.matching_pairs;
+    }
+
+    if (a.distinct != b.distinct) {
+      return a.distinct > b.distinct;
+    }
+  }
+
+  return a.loci < b.loci;
+}
+
+//' Select subsets of loci with high discriminatory power
+//'
+//' Searches for subsets of `size` loci (columns of `haplotypes`, e.g. the loci of a kit in [ystr_kits])
+//' that maximise the number of distinct haplotypes (`criterion = "distinct"`) or
+//' minimise the match rate (`criterion = "match_rate"`), the fraction of pairs of
+//' haplotypes (e.g. of live men from [get_haplotypes_individuals()]) that are identical on the loci.
+//'
+//' The search is a beam search: starting from no loci, each of the (at most) `beam_width` best subsets
+//' is extended by each of the loci not in it, and the `beam_width` best (distinct) subsets are kept.
+//' With `beam_width = 1` this is the greedy search, and a larger `beam_width` explores more subsets
+//' (and is at least as good as the greedy search in the last step, but not necessarily overall).
+//' Ties are broken by the other criterion and then by the loci.
+//'
+//' The haplotypes are kept partitioned in groups of identical haplotypes on the loci in a subset,
+//' so that adding a locus only refines the groups (in time linear in the number of haplotypes),
+//' and the extensions are evaluated in parallel.
+//'
+//' @param haplotypes Integer matrix with a haplotype per row
+//' @param size Number of loci in the subsets
+//' @param criterion `"distinct"` or `"match_rate"`, see details
+//' @param beam_width Number of subsets kept in each step (1 is the greedy search)
+//' @param threads Number of threads; 0 means the OpenMP default.
+//' @param progress Show progress
+//'
+//' @return A list with the (at most) `beam_width` best subsets found, best first:
+//' \itemize{
+//'   \item `loci`: integer matrix with a subset per row: the columns of `haplotypes` in the order they were added.
+//'   \item `distinct`: number of distinct haplotypes on the loci.
+//'   \item `discrimination_capacity`: `distinct` divided by the number of haplotypes.
+//'   \item `match_rate`: fraction of pairs of haplotypes that are identical on the loci.
+//' }
+//' E.g. `colnames(haplotypes)[res$loci[1, ]]` gives the names of the loci in the best subset.
+//'
+//' @seealso [get_haplotypes_individuals()] and [split_by_haplotypes()].
+//'
+//' @export
+// [[Rcpp::export]]
+List haplotypes_select_loci(IntegerMatrix haplotypes,
+                            int size,
+                            std::string criterion = "distinct",
+                            int beam_width = 1,
+                            int threads = 0,
+                            bool progress = true) {
+
+  size_t n = haplotypes.nrow();
+  int loci = haplotypes.ncol();
+
+  if (n == 0) {
+    Rcpp::stop("haplotypes must have at least one row");
+  }
+
+  if (size < 1 || size > loci) {
+    Rcpp::stop("size must be between 1 and the number of loci (columns of haplotypes)");
+  }
+
+  if (criterion != "distinct" && criterion != "match_rate") {
+    Rcpp::stop("criterion must be 'distinct' or 'match_rate'");
+  }
+
+  if (beam_width < 1) {
+    Rcpp::stop("beam_width must be >= 1");
+  }
+
+  if (threads < 0) {
+    Rcpp::stop("threads must be >= 0");
+  }
+
+#ifdef _OPENMP
+  if (threads == 0) {
+    threads = omp_get_max_threads();
+  }
+#else
+  threads = 1;
+#endif
+
+  bool by_distinct = (criterion == "distinct");
+  int max_alleles = 0;
+  std::vector<int> codes = recode_alleles(haplotypes, &max_alleles);
+
+  // no loci: all haplotypes in one group
+  std::vector<LociSubset> beam(1);
+  beam[0].order.resize(n);
+
+  for (size_t i = 0; i < n; ++i) {
+    beam[0].order[i] = i;
+  }
+
+  beam[0].group_begin.push_back(0);
+  beam[0].group_begin.push_back(n);
+  beam[0].matching_pairs = 0.5*(double)n*((double)n - 1.0);
+
+  Progress progress_bar(size, progress);
+
+  for (int step = 0; step < size; ++step) {
+    size_t candidates_count = beam.size() * loci;
+    std::vector<LociCandidate> candidates(candidates_count);
+    std::vector<char> valid(candidates_count, 0); // not vector<bool>: written by several threads
+    bool aborted = false;
+
+    #pragma omp parallel num_threads(threads)
+    {
+      std::vector<int> count(max_alleles, 0); // per thread
+      std::vector<int> touched;
+
+      #pragma omp for schedule(dynamic, 1)
+      for (size_t c = 0; c < candidates_count; ++c) {
+        if (aborted) {
+          continue;
+        }
+
+        const LociSubset& subset = beam[c / loci];
+        int locus = c % loci;
+
+        if (std::find(subset.loci.begin(), subset.loci.end(), locus) != subset.loci.end()) {
+          continue;
+        }
+
+        LociCandidate& cand = candidates[c];
+        cand.subset = c / loci;
+        cand.locus = locus;
+        cand.loci = subset.loci;
+        cand.loci.push_back(locus);
+        std::sort(cand.loci.begin(), cand.loci.end());
+
+        evaluate_refinement(subset, codes.data() + (size_t)locus*n, count, touched,
+                            &cand.distinct, &cand.matching_pairs);
+        valid[c] = 1;
+
+        // only master thread checks
+        if (Progress::check_abort()) {
+          aborted = true;
+        }
+      }
+    }
+
+    if (aborted) {
+      Rcpp::stop("Aborted");
+    }
+
+    std::vector<size_t> ranking;
+
+    for (size_t c = 0; c < candidates_count; ++c) {
+      if (valid[c]) {
+        ranking.push_back(c);
+      }
+    }
+
+    std::sort(ranking.begin(), ranking.end(), [&](size_t a, size_t b) {
+      return candidate_better(candidates[a], candidates[b], by_distinct);
+    });
+
+    // the same subset can be reached from different subsets in the beam
+    std::vector<LociSubset> new_beam;
+    std::set< std::vector<int> > seen;
+
+    for (auto c : ranking) {
+      if (new_beam.size() == (size_t)beam_width) {
+        break;
+      }
+
+      const LociCandidate& cand = candidates[c];
+
+      if (!seen.insert(cand.loci).second) {
+        continue;
+      }
+
+      new_beam.push_back(refine(beam[cand.subset], cand.locus, codes.data() + (size_t)cand.locus*n, max_alleles));
+    }
+
+    beam.swap(new_beam);
+
+    if (progress) {
+      progress_bar.increment();
+    }
+  }
+
+  size_t results = beam.size();
+  IntegerMatrix res_loci(results, size);
+  IntegerVector res_distinct(results);
+  NumericVector res_discrimination_capacity(results);
+  NumericVector res_match_rate(results);
+  double pairs = 0.5*(double)n*((double)n - 1.0);
+
+  for (size_t r = 0; r < results; ++r) {
+    for (int k = 0; k < size; ++k) {
+      res_loci(r, k) = beam[r].loci[k] + 1;
+    }
+
+    res_distinct[r] = beam[r].distinct();
+    res_discrimination_capacity[r] = (double)beam[r].distinct() / (double)n;
+    res_match_rate[r] = (n > 1) ? beam[r].matching_pairs / pairs : 0.0;
+  }
+
+  return List::create(
+    Named("loci") = res_loci,
+    Named("distinct") = res_distinct,
+    Named("discrimination_capacity") = res_discrimination_capacity,
+    Named("match_rate") = res_match_rate);
+}
+
@@ -172,3 +172,30 @@ int pedigree_size_generation(Rcpp::XPtr<Pedigree> pedigree, int generation_upper
 
 
 
+
+//' Random number compatibility mode
+//' 
+//' The simulation of fathers by [sample_geneology()] and [sample_geneology_varying_size()] 
+//' and the populate functions (e.g. [pedigrees_all_populate_haplotypes()] and 
+//' [pedigrees_all_populate_autosomal()]) draw the uniform random numbers they need 
+//' from R's random number generator in bulk.
+//' 
+//' In compatible mode (the default), only random numbers that are known to be used 
+//' are drawn in advance, so the results after `set.seed()` are exactly the same 
+//' as without bulk drawing (and as in earlier versions of the package).
+//' In fast mode (`compatible = FALSE`), random numbers are drawn in larger chunks 
+//' and those left over are discarded. Results are still reproducible by `set.seed()`, 
+//' but differ from those in compatible mode.
+//' 
+//' @param compatible `TRUE` for compatible mode, `FALSE` for fast mode
+//' 
+//' @return The previous mode (`TRUE` if it was compatible)
+//' 
+//' @export
+// [[Rcpp::export]]
+bool set_rng_compatibility(bool compatible = true) {
+  bool previous = get_rng_compatible();
+  set_rng_compatible(compatible);
+  
+  return previous;
+}
@@ -0,0 +1,197 @@
+/**
+ api_utility_sample.cpp
+ Purpose: Logic to sample individuals from a population.
+ Details: API between R user and C++ logic.
+
+ @author Mikkel Meyer Andersen
+ */
+
+#include <RcppArmadillo.h>
+
+// [[Rcpp::depends(RcppArmadillo)]]
+
+#include <algorithm>
+#include <map>
+
+#include "malan_types.h"
+
+using namespace Rcpp;
+
+/*
+Draws an element of v (uniformly), removing it if !replace
+(by moving the last element to its place, so in constant time).
+*/
+static int draw_from(std::vector<int>& v, bool replace, RNG* rng) {
+  size_t k = rng->unif_rand() * v.size();
+  int x = v[k];
+
+  if (!replace) {
+    v[k] = v.back();
+    v.pop_back();
+  }
+
+  return x;
+}
+
+//' Sample individuals from a population
+//'
+//' Draws pids of individuals in generations 0, 1, ..., `generation_upper_bound_in_result`
+//' (e.g. `0` for the end generation, i.e. the live men) with or without replacement,
+//' without going through lists of individuals in R.
+//' The individuals are indexed by generation once per population (the index is kept, and rebuilt
+//' if individuals have been added, e.g. by [extend_geneology()]), so with `weighting = "individual"`
+//' and `strata = "none"` a call takes time proportional to `size` (each draw takes constant time).
+//' Weighting by pedigree and strata group the individuals in each call (as pedigrees may be rebuilt),
+//' and then each draw takes constant time.
+//'
+//' With `strata = "none"`, `size` individuals are drawn, either uniformly (`weighting = "individual"`), or by
+//' first drawing a pedigree uniformly and then an individual in it uniformly (`weighting = "pedigree"`),
+//' so that each pedigree is equally likely regardless of its size.
+//' Without replacement, drawn individuals (and pedigrees with no individuals left) are not drawn again.
+//'
+//' With `strata = "pedigree"` or `strata = "deme"`, `size` individuals are drawn uniformly from each
+//' pedigree or deme (all if it has fewer than `size` individuals and `replace` is `FALSE`),
+//' and the pids are returned stratum by stratum (in the order of pedigree ids and demes).
+//'
+//' Note, that pedigrees must first have been inferred by [build_pedigrees()] for `weighting = "pedigree"`
+//' and `strata = "pedigree"`. As for [sample()], R's random number generator is used.
+//'
+//' @param population Population
+//' @param size Number of individuals to draw (per stratum if `strata` is not `"none"`)
+//' @param generation_upper_bound_in_result Only draw individuals in
+//' generation 0, 1, ... generation_upper_bound_in_result.
+//' -1 means disabled, consider all generations.
+//' @param replace Draw with replacement
+//' @param weighting `"individual"` or `"pedigree"`, see details
+//' @param strata `"none"`, `"pedigree"` or `"deme"`, see details
+//'
+//' @return Vector with the pids drawn
+//'
+//' @seealso [get_pedigree_id_from_pid()], [get_deme_from_pid()] and [get_haplotypes_pids()].
+//'
+//' @export
+// [[Rcpp::export]]
+IntegerVector sample_pids(Rcpp::XPtr<Population> population,
+                          int size,
+                          int generation_upper_bound_in_result = -1,
+                          bool replace = false,
+                          std::string weighting = "individual",
+                          std::string strata = "none") {
+
+  if (size < 0) {
+    Rcpp::stop("size must be >= 0");
+  }
+
+  if (generation_upper_bound_in_result < -1) {
+    Rcpp::stop("generation_upper_bound_in_result must be -1 or >= 0");
+  }
+
+  if (weighting != "individual" && weighting != "pedigree") {
+    Rcpp::stop("weighting must be 'individual' or 'pedigree'");
+  }
+
+  if (strata != "none" && strata != "pedigree" && strata != "deme") {
+    Rcpp::stop("strata must be 'none', 'pedigree' or 'deme'");
+  }
+
+  if (strata != "none" && weighting != "individual") {
+    Rcpp::stop("weighting must be 'individual' when sampling by strata");
+  }
+
+  bool by_pedigree = (weighting == "pedigree" || strata == "pedigree");
+
+  // generations 0, 1, ..., generation_upper_bound_in_result are the first eligible pids
+  const std::vector<int>& pids = population->get_pids_by_generation();
+  size_t eligible = population->get_generation_end(generation_upper_bound_in_result);
+
+  if (size > 0 && eligible == 0) {
+    Rcpp::stop("There are no individuals to draw from (in generations <= generation_upper_bound_in_result)");
+  }
+
+  if (strata == "none" && !replace && (size_t)size > eligible) {
+    Rcpp::stop("Cannot take a sample larger than the number of individuals when replace = FALSE");
+  }
+
+  std::vector<int> drawn;
+  drawn.reserve(size);
+
+  // uniforms for the draws are drawn in bulk, see set_rng_compatibility()
+  BufferedRNG rng;
+
+  if (strata == "none" && weighting == "individual") {
+    rng.reserve(size);
+
+    // without replacement: Fisher-Yates on the eligible pids, where only
+    // the positions swapped are stored (so the index itself is not copied)
+    std::unordered_map<size_t, int> swapped;
+
+    auto pid_at = [&](size_t k) {
+      auto got = swapped.find(k);
+      return (got == swapped.end()) ? pids[k] : got->second;
+    };
+
+    for (int i = 0; i < size; ++i) {
+      if (replace) {
+        drawn.push_back(pids[(size_t)(rng.unif_rand() * eligible)]);
+        continue;
+      }
+
+      size_t k = i + (size_t)(rng.unif_rand() * (eligible - i));
+      int pid_k = pid_at(k);
+      swapped[k] = pid_at(i);
+      drawn.push_back(pid_k);
+    }
+
+    return Rcpp::wrap(drawn);
+  }
+
+  // pids by group (pedigree id or deme) for weighting by pedigree or strata
+  std::unordered_map<int, Individual*>* population_map = population->get_population();
+  std::map<int, std::vector<int> > groups;
+
+  for (size_t i = 0; i < eligible; ++i) {
+    Individual* indv = (*population_map)[pids[i]];
+
+    if (by_pedigree && !indv->pedigree_is_set()) {
+      Rcpp::stop("Pedigrees have not been built, please run build_pedigrees() first");
+    }
+
+    int group = (strata == "deme") ? indv->get_deme() : indv->get_pedigree_id();
+    groups[group].push_back(pids[i]);
+  }
+
+  if (strata == "none") {
+    std::vector< std::vector<int> > pedigrees;
+
+    for (auto& group : groups) {
+      pedigrees.push_back(group.second);
+    }
+
+    // one uniform for the pedigree, and one for the individual
+    rng.reserve(2*size);
+
+    for (int i = 0; i < size; ++i) {
+      size_t k = rng.unif_rand() * pedigrees.size();
+      drawn.push_back(draw_from(pedigrees[k], replace, &rng));
+
+      if (pedigrees[k].empty()) {
+        pedigrees[k].swap(pedigrees.back());
+        pedigrees.pop_back();
+      }
+    }
+  } else {
+    for (auto& group : groups) {
+      std::vector<int>& group_pids = group.second;
+      int group_size = (replace) ? size : std::min((size_t)size, group_pids.size());
+
+      rng.reserve(group_size);
+
+      for (int i = 0; i < group_size; ++i) {
+        drawn.push_back(draw_from(group_pids, replace, &rng));
+      }
+    }
+  }
+
+  return Rcpp::wrap(drawn);
+}
+
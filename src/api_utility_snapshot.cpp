@@ -0,0 +1,397 @@
+/**
+ api_utility_snapshot.cpp
+ Purpose: Logic related to snapshots (column stores) of the most recent generations.
+ Details: API between R user and C++ logic.
+
+ @author Mikkel Meyer Andersen
+ */
+
+#include <RcppArmadillo.h>
+
+// [[Rcpp::depends(RcppArmadillo)]]
+
+#include <cstdio>
+
+#include "malan_types.h"
+
+using namespace Rcpp;
+
+static std::vector<int> snapshot_haplotype_argument(const PopulationSnapshot& snapshot, const IntegerVector& haplotype) {
+  if (haplotype.size() != snapshot.get_loci()) {
+    Rcpp::stop("haplotype must have as many loci as the snapshot");
+  }
+
+  return Rcpp::as< std::vector<int> >(haplotype);
+}
+
+static int snapshot_row_argument(const PopulationSnapshot& snapshot, int pid) {
+  int row = snapshot.get_row(pid);
+
+  if (row == -1) {
+    Rcpp::stop("Individual with pid = " + std::to_string(pid) + " is not in the snapshot");
+  }
+
+  return row;
+}
+
+//' Snapshot of the most recent generations
+//'
+//' Freezes the individuals in generation 0, 1, ..., `generation_upper_bound_in_result` into
+//' a compact column store: pid, generation, pedigree id, father's pid, haplotype and
+//' a fingerprint (hash) of the haplotype, sorted by pedigree id and then haplotype.
+//' Queries on the snapshot ([snapshot_count_haplotype_occurrences()],
+//' [snapshot_haplotype_matches()], [snapshot_count_haplotype_occurrences_pedigree()],
+//' [snapshot_family_info()] and [snapshot_mixture_info()])
+//' run over contiguous arrays (and an index of the fingerprints) instead of the individuals.
+//'
+//' The snapshot is a copy: later changes to the population (e.g. new haplotypes) are not reflected.
+//'
+//' Note, that pedigrees must first have been inferred by [build_pedigrees()] and haplotypes populated.
+//'
+//' @param population Population
+//' @param generation_upper_bound_in_result Include individuals in generation 0, 1, ... generation_upper_bound_in_result.
+//' -1 means disabled, include all generations.
+//'
+//' @return A snapshot (`malan_snapshot`)
+//'
+//' @seealso [snapshot_data()] and [snapshot_haplotypes()].
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::XPtr<PopulationSnapshot> population_snapshot(Rcpp::XPtr<Population> population,
+                                                   int generation_upper_bound_in_result = -1) {
+
+  if (generation_upper_bound_in_result < -1) {
+    Rcpp::stop("generation_upper_bound_in_result must be -1 or >= 0");
+  }
+
+  PopulationSnapshot* snapshot = nullptr;
+
+  try {
+    snapshot = new PopulationSnapshot(*(population->get_population()), generation_upper_bound_in_result);
+  } catch (std::exception& e) {
+    Rcpp::stop(e.what());
+  }
+
+  Rcpp::XPtr<PopulationSnapshot> res(snapshot, RCPP_XPTR_2ND_ARG_CLEANER);
+  res.attr("class") = CharacterVector::create("malan_snapshot", "externalptr");
+
+  return res;
+}
+
+//' Columns of a snapshot
+//'
+//' @param snapshot Snapshot from [population_snapshot()]
+//'
+//' @return A data frame with a row per individual (in the order of the snapshot) and
+//' `pid`, `generation`, `pedigree_id`, `father_pid` (`NA` for founders) and `fingerprint` (hexadecimal)
+//'
+//' @seealso [snapshot_haplotypes()].
+//'
+//' @export
+// [[Rcpp::export]]
+DataFrame snapshot_data(Rcpp::XPtr<PopulationSnapshot> snapshot) {
+  size_t n = snapshot->size();
+  IntegerVector pid(n);
+  IntegerVector generation(n);
+  IntegerVector pedigree_id(n);
+  IntegerVector father_pid(n);
+  CharacterVector fingerprint(n);
+  char buffer[17];
+
+  for (size_t r = 0; r < n; ++r) {
+    pid[r] = snapshot->get_pid(r);
+    generation[r] = snapshot->get_generation(r);
+    pedigree_id[r] = snapshot->get_pedigree_id(r);
+    father_pid[r] = (snapshot->get_father_pid(r) == 0) ? NA_INTEGER : snapshot->get_father_pid(r);
+
+    std::snprintf(buffer, sizeof(buffer), "%016llx", (unsigned long long)snapshot->get_fingerprint(r));
+    fingerprint[r] = std::string(buffer);
+  }
+
+  return DataFrame::create(
+    Named("pid") = pid,
+    Named("generation") = generation,
+    Named("pedigree_id") = pedigree_id,
+    Named("father_pid") = father_pid,
+    Named("fingerprint") = fingerprint,
+    Named("stringsAsFactors") = false);
+}
+
+//' Haplotypes of a snapshot
+//'
+//' @param snapshot Snapshot from [population_snapshot()]
+//'
+//' @return Matrix with a haplotype per row (in the order of [snapshot_data()])
+//'
+//' @seealso [snapshot_data()].
+//'
+//' @export
+// [[Rcpp::export]]
+IntegerMatrix snapshot_haplotypes(Rcpp::XPtr<PopulationSnapshot> snapshot) {
+  size_t n = snapshot->size();
+  size_t loci = snapshot->get_loci();
+  IntegerMatrix haplotypes(n, loci);
+
+  for (size_t r = 0; r < n; ++r) {
+    const int* h = snapshot->get_haplotype(r);
+
+    for (size_t loc = 0; loc < loci; ++loc) {
+      haplotypes(r, loc) = h[loc];
+    }
+  }
+
+  return haplotypes;
+}
+
+//' Count haplotypes occurrences in a snapshot
+//'
+//' As [count_haplotype_occurrences_individuals()] for the individuals in the snapshot, but
+//' by looking up the fingerprint of `haplotype`.
+//'
+//' @param snapshot Snapshot from [population_snapshot()]
+//' @param haplotype Haplotype to count occurrences of
+//'
+//' @return Number of individuals in the snapshot with `haplotype`
+//'
+//' @seealso [population_snapshot()].
+//'
+//' @export
+// [[Rcpp::export]]
+int snapshot_count_haplotype_occurrences(Rcpp::XPtr<PopulationSnapshot> snapshot, IntegerVector haplotype) {
+  std::vector<int> h = snapshot_haplotype_argument(*snapshot, haplotype);
+
+  return snapshot->count_matches(h.data());
+}
+
+//' Haplotype matches in a snapshot
+//'
+//' As [haplotype_matches_individuals()] for the individuals in the snapshot, but
+//' by looking up the fingerprint of `haplotype`, and returning pids.
+//'
+//' @param snapshot Snapshot from [population_snapshot()]
+//' @param haplotype Haplotype to find matches of
+//'
+//' @return Vector with the pids of the individuals in the snapshot with `haplotype` (in the order of the snapshot)
+//'
+//' @seealso [population_snapshot()].
+//'
+//' @export
+// [[Rcpp::export]]
+IntegerVector snapshot_haplotype_matches(Rcpp::XPtr<PopulationSnapshot> snapshot, IntegerVector haplotype) {
+  std::vector<int> h = snapshot_haplotype_argument(*snapshot, haplotype);
+  std::vector<int> rows;
+  snapshot->matches(h.data(), rows);
+
+  IntegerVector pids(rows.size());
+
+  for (size_t k = 0; k < rows.size(); ++k) {
+    pids[k] = snapshot->get_pid(rows[k]);
+  }
+
+  return pids;
+}
+
+//' Count haplotypes occurrences in a pedigree in a snapshot
+//'
+//' As [count_haplotype_occurrences_pedigree()] for the individuals in the snapshot, but
+//' by binary search (a pedigree's individuals are contiguous and sorted by haplotype).
+//'
+//' @param snapshot Snapshot from [population_snapshot()]
+//' @param pedigree_id Pedigree id (see [get_pedigree_id_from_pid()])
+//' @param haplotype Haplotype to count occurrences of
+//'
+//' @return Number of individuals in the snapshot in the pedigree with `haplotype`
+//'
+//' @seealso [population_snapshot()].
+//'
+//' @export
+// [[Rcpp::export]]
+int snapshot_count_haplotype_occurrences_pedigree(Rcpp::XPtr<PopulationSnapshot> snapshot, int pedigree_id,
+                                                  IntegerVector haplotype) {
+  std::vector<int> h = snapshot_haplotype_argument(*snapshot, haplotype);
+  int begin = 0;
+  int end = 0;
+  snapshot->pedigree_haplotype_rows(pedigree_id, h.data(), &begin, &end);
+
+  return end - begin;
+}
+
+// as get_family_info(), where relatives not in the snapshot give NA
+static List snapshot_family_info_row(const PopulationSnapshot& snapshot, int row) {
+  int father_pid = snapshot.get_father_pid(row);
+
+  if (father_pid == 0) {
+    Rcpp::stop("Individual did not have a father");
+  }
+
+  int pedigree_id = snapshot.get_pedigree_id(row);
+  const int* h = snapshot.get_haplotype(row);
+  size_t loci = snapshot.get_loci();
+
+  // brothers are in the same generation, so in the snapshot
+  int begin = 0;
+  int end = 0;
+  int brothers = 0;
+  snapshot.pedigree_rows(pedigree_id, &begin, &end);
+
+  for (int r = begin; r < end; ++r) {
+    if (r != row && snapshot.get_father_pid(r) == father_pid) {
+      brothers += 1;
+    }
+  }
+
+  // matching brothers have the same haplotype, so are contiguous
+  int brothers_matching = 0;
+  snapshot.pedigree_haplotype_rows(pedigree_id, h, &begin, &end);
+
+  for (int r = begin; r < end; ++r) {
+    if (r != row && snapshot.get_father_pid(r) == father_pid) {
+      brothers_matching += 1;
+    }
+  }
+
+  int father_row = snapshot.get_father_row(row);
+  int father_matches = NA_LOGICAL;
+  int grandfather_matches = NA_LOGICAL;
+  int uncles = NA_INTEGER;
+
+  if (father_row != -1) {
+    const int* h_father = snapshot.get_haplotype(father_row);
+    father_matches = std::equal(h, h + loci, h_father);
+
+    int grandfather_pid = snapshot.get_father_pid(father_row);
+    int grandfather_row = snapshot.get_father_row(father_row);
+
+    if (grandfather_row != -1) {
+      const int* h_grandfather = snapshot.get_haplotype(grandfather_row);
+      grandfather_matches = std::equal(h, h + loci, h_grandfather);
+    }
+
+    if (grandfather_pid != 0) {
+      snapshot.pedigree_rows(pedigree_id, &begin, &end);
+      uncles = 0;
+
+      for (int r = begin; r < end; ++r) {
+        if (r != father_row && snapshot.get_father_pid(r) == grandfather_pid) {
+          uncles += 1;
+        }
+      }
+    }
+  }
+
+  return List::create(
+    Named("num_brothers") = brothers,
+    Named("num_brothers_matching") = brothers_matching,
+    Named("father_matches") = LogicalVector::create(father_matches),
+    Named("grandfather_matches") = LogicalVector::create(grandfather_matches),
+    Named("num_uncles") = uncles);
+}
+
+//' Family information from a snapshot
+//'
+//' As [get_family_info()] for an individual in the snapshot, where
+//' `father_matches`, `grandfather_matches` and `num_uncles` are `NA`
+//' if the father or grandfather are not in the snapshot
+//' (use a larger `generation_upper_bound_in_result` in [population_snapshot()]).
+//'
+//' @param snapshot Snapshot from [population_snapshot()]
+//' @param pid pid of an individual in the snapshot
+//'
+//' @return A list with `num_brothers`, `num_brothers_matching`, `father_matches`, `grandfather_matches` and `num_uncles`
+//'
+//' @seealso [population_snapshot()].
+//'
+//' @export
+// [[Rcpp::export]]
+List snapshot_family_info(Rcpp::XPtr<PopulationSnapshot> snapshot, int pid) {
+  return snapshot_family_info_row(*snapshot, snapshot_row_argument(*snapshot, pid));
+}
+
+//' Mixture information from a snapshot
+//'
+//' As [mixture_info_by_individuals()] with the individuals in the snapshot as possible contributors,
+//' but without the meiotic distances (that need the ancestors);
+//' the donors must be in the snapshot.
+//'
+//' @param snapshot Snapshot from [population_snapshot()]
+//' @param donor1_pid pid of contributor 1/donor 1
+//' @param donor2_pid pid of contributor 2/donor 2
+//'
+//' @return A list with mixture information about the mixture of `donor1_pid` and `donor2_pid`,
+//' see [mixture_info_by_individuals()]
+//'
+//' @seealso [population_snapshot()].
+//'
+//' @export
+// [[Rcpp::export]]
+List snapshot_mixture_info(Rcpp::XPtr<PopulationSnapshot> snapshot, int donor1_pid, int donor2_pid) {
+  int row1 = snapshot_row_argument(*snapshot, donor1_pid);
+  int row2 = snapshot_row_argument(*snapshot, donor2_pid);
+  size_t n = snapshot->size();
+  size_t loci = snapshot->get_loci();
+
+  const int* H1 = snapshot->get_haplotype(row1);
+  const int* H2 = snapshot->get_haplotype(row2);
+
+  size_t loci_not_matching = 0;
+
+  for (size_t locus = 0; locus < loci; ++locus) {
+    if (H1[locus] != H2[locus]) {
+      loci_not_matching += 1;
+    }
+  }
+
+  std::vector<int> res_comp_with_mixture;
+  std::vector<int> res_match_donor1;
+  std::vector<int> res_match_donor2;
+  std::vector<int> res_others_included;
+
+  for (size_t r = 0; r < n; ++r) {
+    const int* h = snapshot->get_haplotype(r);
+    bool in_mixture = true;
+    bool match_H1 = true;
+    bool match_H2 = true;
+
+    for (size_t locus = 0; locus < loci; ++locus) {
+      in_mixture = in_mixture && (h[locus] == H1[locus] || h[locus] == H2[locus]);
+      match_H1 = match_H1 && (h[locus] == H1[locus]);
+      match_H2 = match_H2 && (h[locus] == H2[locus]);
+    }
+
+    if (!in_mixture) {
+      continue;
+    }
+
+    int pid = snapshot->get_pid(r);
+    res_comp_with_mixture.push_back(pid);
+
+    if (match_H1) {
+      res_match_donor1.push_back(pid);
+    }
+
+    if (match_H2) {
+      res_match_donor2.push_back(pid);
+    }
+
+    if (!match_H1 && !match_H2) {
+      res_others_included.push_back(pid);
+    }
+  }
+
+  List res;
+  res["pids_included_in_mixture"] = res_comp_with_mixture;
+  res["pids_matching_donor1"] = res_match_donor1;
+  res["pids_matching_donor2"] = res_match_donor2;
+  res["pids_others_included"] = res_others_included;
+  res["donor1_family_info"] = snapshot_family_info_row(*snapshot, row1);
+  res["donor2_family_info"] = snapshot_family_info_row(*snapshot, row2);
+  res["donor1_profile"] = std::vector<int>(H1, H1 + loci);
+  res["donor2_profile"] = std::vector<int>(H2, H2 + loci);
+  res["donor1_pid"] = donor1_pid;
+  res["donor2_pid"] = donor2_pid;
+  res["loci_not_matching"] = loci_not_matching;
+
+  return res;
+}
+
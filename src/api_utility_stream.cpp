@@ -0,0 +1,275 @@
+/**
+ api_utility_stream.cpp
+ Purpose: Logic for (out-of-core) analyses of streamed simulations.
+ Details: API between R user and C++ logic.
+
+ @author Mikkel Meyer Andersen
+ */
+
+#include <RcppArmadillo.h>
+
+// [[Rcpp::depends(RcppProgress)]]
+// [[Rcpp::depends(RcppArmadillo)]]
+
+#include <progress.hpp>
+
+#include <fstream>
+
+#include "malan_types.h"
+
+using namespace Rcpp;
+
+//' Pedigrees of a streamed geneology
+//'
+//' Finds the pedigree of each individual in the end generation of a geneology
+//' written to a file by [sample_geneology_stream()], as [build_pedigrees()] does for
+//' a geneology in memory: two individuals are in the same pedigree if
+//' they have a common ancestor.
+//'
+//' The file is read once, from the youngest to the oldest generation,
+//' keeping track of each individual's ancestor, so only memory for
+//' the end generation is used (the file is memory-mapped).
+//'
+//' @param file Name of file written by [sample_geneology_stream()].
+//' @param progress Show progress.
+//'
+//' @return A list with `pedigree_ids` (for each individual in the end generation,
+//' the pedigree id 1, 2, ..., numbered by first appearance) and `pedigrees` (the number of pedigrees).
+//'
+//' @seealso [sample_geneology_stream()] and [stream_populate_haplotypes()].
+//'
+//' @export
+// [[Rcpp::export]]
+List stream_pedigrees(std::string file, bool progress = true) {
+  GenerationFileReader reader(file);
+  size_t population_size = reader.get_population_size();
+  size_t records = reader.get_records_count();
+
+  // ancestor[i]: index of the oldest known ancestor of individual i
+  std::vector<int> ancestor(population_size);
+
+  for (size_t i = 0; i < population_size; ++i) {
+    ancestor[i] = i;
+  }
+
+  Progress progress_bar(records, progress);
+
+  for (size_t k = 0; k < records; ++k) {
+    const int* fathers = reader.get_fathers(k);
+
+    for (size_t i = 0; i < population_size; ++i) {
+      if (i % CHECK_ABORT_EVERY == 0 && Progress::check_abort()) {
+        Rcpp::stop("Aborted");
+      }
+
+      int father_i = fathers[ancestor[i]];
+
+      // ancestors of the end generation always have a father drawn
+      if (father_i < 0) {
+        Rcpp::stop("Ancestor without father, the file is inconsistent");
+      }
+
+      ancestor[i] = father_i;
+    }
+
+    if (progress) {
+      progress_bar.increment();
+    }
+  }
+
+  IntegerVector pedigree_ids(population_size);
+  std::vector<int> ancestor_pedigree_id(population_size, 0); // 0: not seen yet
+  int pedigrees = 0;
+
+  for (size_t i = 0; i < population_size; ++i) {
+    if (ancestor_pedigree_id[ancestor[i]] == 0) {
+      pedigrees += 1;
+      ancestor_pedigree_id[ancestor[i]] = pedigrees;
+    }
+
+    pedigree_ids[i] = ancestor_pedigree_id[ancestor[i]];
+  }
+
+  List res;
+  res["pedigree_ids"] = pedigree_ids;
+  res["pedigrees"] = pedigrees;
+
+  return res;
+}
+
+//' Populate haplotypes in a streamed geneology
+//'
+//' Populates haplotypes in a geneology written to a file by [sample_geneology_stream()]
+//' as [pedigrees_all_populate_haplotypes()] does for a geneology in memory:
+//' the founders (in the oldest generation) have haplotype 0, 0, ..., 0
+//' and each son gets his father's haplotype with mutations
+//' (at each locus, with probability given by `mutation_rates`, one step up or down
+//' with equal probability).
+//'
+//' The file is read once, from the oldest to the youngest generation,
+//' keeping only the haplotypes of two generations in memory (the file is memory-mapped).
+//' The haplotypes of the end generation are written to `haplotypes_file`
+//' that can be queried by [stream_haplotypes()] and [stream_count_haplotype_occurrences()].
+//'
+//' @param file Name of file written by [sample_geneology_stream()].
+//' @param mutation_rates Vector with mutation rates, length `loci`
+//' @param haplotypes_file Name of file to write the haplotypes of the end generation to.
+//' @param progress Show progress.
+//'
+//' @seealso [stream_pedigrees()], [stream_haplotypes()] and [stream_count_haplotype_occurrences()].
+//'
+//' @export
+// [[Rcpp::export]]
+void stream_populate_haplotypes(std::string file,
+                                Rcpp::NumericVector mutation_rates,
+                                std::string haplotypes_file,
+                                bool progress = true) {
+
+  std::vector<double> mut_rates = Rcpp::as< std::vector<double> >(mutation_rates);
+  size_t loci = mut_rates.size();
+
+  if (loci == 0) {
+    Rcpp::stop("mutation_rates must have at least one locus");
+  }
+
+  GenerationFileReader reader(file);
+  size_t population_size = reader.get_population_size();
+  size_t records = reader.get_records_count();
+
+  // haplotypes of the fathers' and of the children's generation
+  std::vector<int> fathers_haplotypes(population_size * loci, 0);
+  std::vector<int> children_haplotypes(population_size * loci, 0);
+
+  // uniforms for the mutations are drawn in bulk, see set_rng_compatibility()
+  BufferedRNG rng;
+
+  Progress progress_bar(records, progress);
+
+  for (size_t k = records; k-- > 0; ) {
+    const int* fathers = reader.get_fathers(k);
+
+    for (size_t i = 0; i < population_size; ++i) {
+      if (i % CHECK_ABORT_EVERY == 0 && Progress::check_abort()) {
+        Rcpp::stop("Aborted");
+      }
+
+      // no descendants in the end generation, haplotype not needed
+      if (fathers[i] < 0) {
+        continue;
+      }
+
+      rng.reserve(loci);
+
+      const int* h_father = &(fathers_haplotypes[fathers[i] * loci]);
+      int* h = &(children_haplotypes[i * loci]);
+
+      // as Individual::haplotype_mutate()
+      for (size_t loc = 0; loc < loci; ++loc) {
+        h[loc] = h_father[loc];
+
+        if (rng.unif_rand() < mut_rates[loc]) {
+          if (rng.unif_rand() < 0.5) {
+            h[loc] = h[loc] - 1;
+          } else {
+            h[loc] = h[loc] + 1;
+          }
+        }
+      }
+    }
+
+    fathers_haplotypes.swap(children_haplotypes);
+
+    if (progress) {
+      progress_bar.increment();
+    }
+  }
+
+  // fathers_haplotypes is now the end generation
+  std::ofstream out(haplotypes_file.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+  if (!out) {
+    Rcpp::stop("Could not open haplotypes_file for writing");
+  }
+
+  int32_t header[3] = { HAPLOTYPE_FILE_VERSION, (int32_t)population_size, (int32_t)loci };
+  out.write(HAPLOTYPE_FILE_MAGIC, 8);
+  out.write(reinterpret_cast<const char*>(header), sizeof(header));
+  out.write(reinterpret_cast<const char*>(fathers_haplotypes.data()), fathers_haplotypes.size()*sizeof(int32_t));
+  out.close();
+
+  if (out.fail()) {
+    Rcpp::stop("Could not write haplotypes_file");
+  }
+}
+
+//' Get haplotypes from a streamed geneology
+//'
+//' @param haplotypes_file Name of file written by [stream_populate_haplotypes()].
+//' @param individuals Indices (1, 2, ..., population size) of individuals in the end generation.
+//'
+//' @return Matrix with haplotypes in rows
+//'
+//' @seealso [stream_populate_haplotypes()].
+//'
+//' @export
+// [[Rcpp::export]]
+IntegerMatrix stream_haplotypes(std::string haplotypes_file, IntegerVector individuals) {
+  HaplotypeFileReader reader(haplotypes_file);
+  size_t population_size = reader.get_population_size();
+  size_t loci = reader.get_loci();
+
+  int n = individuals.size();
+  IntegerMatrix haps(n, loci);
+
+  for (int k = 0; k < n; ++k) {
+    if (individuals[k] == NA_INTEGER || individuals[k] < 1 || (size_t)individuals[k] > population_size) {
+      Rcpp::stop("individuals must be between 1 and the population size");
+    }
+
+    const int* h = reader.get_haplotype(individuals[k] - 1);
+
+    for (size_t loc = 0; loc < loci; ++loc) {
+      haps(k, loc) = h[loc];
+    }
+  }
+
+  return haps;
+}
+
+//' Count haplotypes occurrences in a streamed geneology
+//'
+//' Counts the number of individuals in the end generation with haplotype `haplotype`
+//' by one pass over the (memory-mapped) file.
+//'
+//' @param haplotypes_file Name of file written by [stream_populate_haplotypes()].
+//' @param haplotype Haplotype to count occurrences of.
+//'
+//' @return Number of times that `haplotype` occurred in the end generation
+//'
+//' @seealso [stream_populate_haplotypes()] and [count_haplotype_occurrences_individuals()].
+//'
+//' @export
+// [[Rcpp::export]]
+int stream_count_haplotype_occurrences(std::string haplotypes_file, IntegerVector haplotype) {
+  HaplotypeFileReader reader(haplotypes_file);
+  size_t population_size = reader.get_population_size();
+  size_t loci = reader.get_loci();
+
+  if (haplotype.size() != loci) {
+    Rcpp::stop("haplotype must have the same number of loci as in haplotypes_file");
+  }
+
+  std::vector<int> h = Rcpp::as< std::vector<int> >(haplotype);
+  int count = 0;
+
+  for (size_t i = 0; i < population_size; ++i) {
+    const int* h_i = reader.get_haplotype(i);
+
+    if (std::equal(h.begin(), h.end(), h_i)) {
+      count += 1;
+    }
+  }
+
+  return count;
+}
+
@@ -0,0 +1,187 @@
+/**
+ api_utility_subtree.cpp
+ Purpose: Logic related to statistics of individuals' descendants.
+ Details: API between R user and C++ logic.
+
+ @author Mikkel Meyer Andersen
+ */
+
+#include <RcppArmadillo.h>
+
+// [[Rcpp::depends(RcppProgress)]]
+// [[Rcpp::depends(RcppArmadillo)]]
+
+#include <progress.hpp>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "malan_types.h"
+
+using namespace Rcpp;
+
+//' Compute statistics of the descendants of all individuals
+//'
+//' For each individual in `pedigrees`, the number of descendants,
+//' the number of descendants in each of the generations 0, 1, ..., `generation_max`
+//' (e.g. with `generation_max = 0`, the number of live descendants in the end generation),
+//' the depth (the number of generations down to the youngest descendant) and,
+//' if `haplotypes` is `TRUE`, the number of distinct haplotypes amongst the individual
+//' and his descendants in generations 0, 1, ..., `generation_max` are computed.
+//'
+//' This is done in one pass per pedigree, from the youngest generation to the root,
+//' and pedigrees are done in parallel.
+//' The statistics can be looked up by [get_subtree_statistics()].
+//'
+//' Note, that pedigrees must first have been inferred by [build_pedigrees()]
+//' (and haplotypes populated, if `haplotypes` is `TRUE`).
+//'
+//' @param pedigrees Pedigree list
+//' @param generation_max Count descendants in generations 0, 1, ..., `generation_max`
+//' @param haplotypes Count distinct haplotypes
+//' @param threads Number of threads; 0 means the OpenMP default.
+//' @param progress Show progress
+//'
+//' @return An external pointer to the statistics (class `malan_subtree_statistics`)
+//'
+//' @seealso [get_subtree_statistics()].
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::XPtr<SubtreeStatistics> subtree_statistics(Rcpp::XPtr< std::vector<Pedigree*> > pedigrees,
+                                                 int generation_max = 0,
+                                                 bool haplotypes = false,
+                                                 int threads = 0,
+                                                 bool progress = true) {
+
+  if (generation_max < 0) {
+    Rcpp::stop("generation_max must be >= 0");
+  }
+
+  if (threads < 0) {
+    Rcpp::stop("threads must be >= 0");
+  }
+
+#ifdef _OPENMP
+  if (threads == 0) {
+    threads = omp_get_max_threads();
+  }
+#else
+  threads = 1;
+#endif
+
+  // built on the main thread as Pedigree::get_root() may call R
+  PedigreeIndex index(*pedigrees);
+  SubtreeStatistics* statistics = new SubtreeStatistics(index, generation_max, haplotypes);
+  Rcpp::XPtr<SubtreeStatistics> statistics_xptr(statistics, RCPP_XPTR_2ND_ARG_CLEANER);
+  statistics_xptr.attr("class") = CharacterVector::create("malan_subtree_statistics", "externalptr");
+
+  int pedigrees_count = index.get_pedigrees_count();
+  Progress progress_bar(pedigrees_count, progress);
+  bool aborted = false;
+
+  #pragma omp parallel for schedule(dynamic, 1) num_threads(threads)
+  for (int p = 0; p < pedigrees_count; ++p) {
+    if (aborted) {
+      continue;
+    }
+
+    statistics->compute_pedigree(index, p);
+
+    // only master thread checks (and the progress bar is thread safe)
+    if (Progress::check_abort()) {
+      aborted = true;
+    }
+
+    if (progress) {
+      progress_bar.increment();
+    }
+  }
+
+  if (aborted) {
+    Rcpp::stop("Aborted");
+  }
+
+  return statistics_xptr;
+}
+
+//' Get statistics of individuals' descendants
+//'
+//' @param statistics Statistics computed by [subtree_statistics()]
+//' @param pids Pids of the individuals to get the statistics of; `NULL` for all individuals
+//'
+//' @return A data frame with a row per individual with `pid`, `generation`,
+//' the number of descendants (`descendants`), the depth (`depth`),
+//' the number of distinct haplotypes (`distinct_haplotypes`; `NA` if not computed)
+//' and, for each of the generations `g` = 0, 1, ..., `generation_max`, the number of descendants
+//' in generation `g` (`descendants_generation_g`).
+//'
+//' @seealso [subtree_statistics()].
+//'
+//' @export
+// [[Rcpp::export]]
+Rcpp::DataFrame get_subtree_statistics(Rcpp::XPtr<SubtreeStatistics> statistics,
+                                       Rcpp::Nullable<Rcpp::IntegerVector> pids = R_NilValue) {
+
+  std::vector<int> indices;
+
+  if (pids.isNull()) {
+    for (int i = 0; i < statistics->size(); ++i) {
+      indices.push_back(i);
+    }
+  } else {
+    Rcpp::IntegerVector pids_vec(pids.get());
+
+    for (auto pid : pids_vec) {
+      int i = statistics->get_index(pid);
+
+      if (i == -1) {
+        Rcpp::stop("Individual with pid = " + std::to_string(pid) + " not in statistics");
+      }
+
+      indices.push_back(i);
+    }
+  }
+
+  size_t n = indices.size();
+  int buckets = statistics->get_generation_max() + 1;
+
+  IntegerVector pid(n);
+  IntegerVector generation(n);
+  IntegerVector descendants(n);
+  IntegerVector depth(n);
+  IntegerVector distinct_haplotypes(n);
+  IntegerMatrix descendants_generation(n, buckets);
+
+  for (size_t k = 0; k < n; ++k) {
+    int i = indices[k];
+
+    pid[k] = statistics->get_pid(i);
+    generation[k] = statistics->get_generation(i);
+    descendants[k] = statistics->get_descendants(i);
+    depth[k] = statistics->get_depth(i);
+    distinct_haplotypes[k] = (statistics->has_haplotypes()) ? statistics->get_distinct_haplotypes(i) : NA_INTEGER;
+
+    for (int g = 0; g < buckets; ++g) {
+      descendants_generation(k, g) = statistics->get_descendants_generation(i, g);
+    }
+  }
+
+  List res;
+  res["pid"] = pid;
+  res["generation"] = generation;
+  res["descendants"] = descendants;
+  res["depth"] = depth;
+  res["distinct_haplotypes"] = distinct_haplotypes;
+
+  for (int g = 0; g < buckets; ++g) {
+    res["descendants_generation_" + std::to_string(g)] = descendants_generation(_, g);
+  }
+
+  res.attr("class") = "data.frame";
+  res.attr("row.names") = IntegerVector::create(NA_INTEGER, -(int)n);
+
+  return Rcpp::DataFrame(res);
+}
+
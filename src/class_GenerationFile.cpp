@@ -0,0 +1,178 @@
+/**
+ class_GenerationFile.cpp
+ Purpose: C++ classes reading files written by a streamed simulation.
+ Details: C++ implementation.
+  
+ @author Mikkel Meyer Andersen
+ */
+
+#include "malan_types.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*****************************************
+MappedFile
+******************************************/
+MappedFile::MappedFile(const std::string& filename) {
+#ifndef _WIN32
+  int fd = open(filename.c_str(), O_RDONLY);
+  
+  if (fd == -1) {
+    throw std::invalid_argument("Could not open file");
+  }
+  
+  struct stat st;
+  
+  if (fstat(fd, &st) == -1) {
+    close(fd);
+    throw std::runtime_error("Could not get size of file");
+  }
+  
+  m_size = st.st_size;
+  
+  if (m_size > 0) {
+    void* p = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+    
+    if (p == MAP_FAILED) {
+      close(fd);
+      throw std::runtime_error("Could not map file");
+    }
+    
+    // no madvise(): records are read both backward and forward (pedigrees),
+    // and at random (haplotypes), so the kernel's default readahead is best
+    
+    m_data = static_cast<const char*>(p);
+    m_mapped = true;
+  }
+  
+  // the mapping stays valid after the file is closed
+  close(fd);
+#else
+  std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+  
+  if (!in) {
+    throw std::invalid_argument("Could not open file");
+  }
+  
+  m_size = in.tellg();
+  m_buffer.resize(m_size);
+  in.seekg(0, std::ios::beg);
+  in.read(m_buffer.data(), m_size);
+  
+  if (!in) {
+    throw std::runtime_error("Could not read file");
+  }
+  
+  m_data = m_buffer.data();
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifndef _WIN32
+  if (m_mapped) {
+    munmap(const_cast<char*>(m_data), m_size);
+  }
+#endif
+}
+
+const char* MappedFile::data() const {
+  return m_data;
+}
+
+size_t MappedFile::size() const {
+  return m_size;
+}
+
+
+/*****************************************
+GenerationFileReader
+******************************************/
+GenerationFileReader::GenerationFileReader(const std::string& filename) : m_file(filename) {
+  int32_t header[2];
+  
+  if (m_file.size() < 8 + sizeof(header) || std::memcmp(m_file.data(), GENERATION_SINK_FILE_MAGIC, 8) != 0) {
+    throw std::invalid_argument("Not a file written by sample_geneology_stream()");
+  }
+  
+  std::memcpy(header, m_file.data() + 8, sizeof(header));
+  
+  if (header[0] != GENERATION_SINK_FILE_VERSION) {
+    throw std::invalid_argument("Unsupported file version");
+  }
+  
+  m_population_size = header[1];
+  m_record_size = (1 + m_population_size)*sizeof(int32_t);
+  
+  size_t records_bytes = m_file.size() - 8 - sizeof(header);
+  
+  if (records_bytes % m_record_size != 0) {
+    throw std::invalid_argument("File is truncated");
+  }
+  
+  m_records_count = records_bytes / m_record_size;
+}
+
+size_t GenerationFileReader::get_population_size() const {
+  return m_population_size;
+}
+
+size_t GenerationFileReader::get_records_count() const {
+  return m_records_count;
+}
+
+int GenerationFileReader::get_generation(size_t k) const {
+  int32_t generation;
+  std::memcpy(&generation, m_file.data() + 16 + k*m_record_size, sizeof(generation));
+  return generation;
+}
+
+const int* GenerationFileReader::get_fathers(size_t k) const {
+  // records start at 4 byte boundaries
+  return reinterpret_cast<const int*>(m_file.data() + 16 + k*m_record_size + sizeof(int32_t));
+}
+
+
+/*****************************************
+HaplotypeFileReader
+******************************************/
+HaplotypeFileReader::HaplotypeFileReader(const std::string& filename) : m_file(filename) {
+  int32_t header[3];
+  
+  if (m_file.size() < 8 + sizeof(header) || std::memcmp(m_file.data(), HAPLOTYPE_FILE_MAGIC, 8) != 0) {
+    throw std::invalid_argument("Not a file written by stream_populate_haplotypes()");
+  }
+  
+  std::memcpy(header, m_file.data() + 8, sizeof(header));
+  
+  if (header[0] != HAPLOTYPE_FILE_VERSION) {
+    throw std::invalid_argument("Unsupported file version");
+  }
+  
+  m_population_size = header[1];
+  m_loci = header[2];
+  
+  if (m_file.size() != 8 + sizeof(header) + m_population_size*m_loci*sizeof(int32_t)) {
+    throw std::invalid_argument("File is truncated");
+  }
+}
+
+size_t HaplotypeFileReader::get_population_size() const {
+  return m_population_size;
+}
+
+size_t HaplotypeFileReader::get_loci() const {
+  return m_loci;
+}
+
+const int* HaplotypeFileReader::get_haplotype(size_t i) const {
+  return reinterpret_cast<const int*>(m_file.data() + 20 + i*m_loci*sizeof(int32_t));
+}
@@ -0,0 +1,75 @@
+/**
+ class_GenerationFile.h
+ Purpose: Header for C++ classes reading files written by a streamed simulation.
+ Details: C++ header.
+  
+ @author Mikkel Meyer Andersen
+ */
+
+#include <string>
+#include <vector>
+
+#define HAPLOTYPE_FILE_MAGIC "MALANHAP"
+#define HAPLOTYPE_FILE_VERSION 1
+
+/*
+MappedFile gives read-only access to an entire file. 
+The file is memory-mapped (so it is paged in by the OS as needed and may be 
+larger than RAM), except on Windows where it is read into memory.
+
+GenerationFileReader gives random access to the generations in a file 
+written by FileGenerationSink (see class_GenerationSink.h); 
+record k (0, 1, ..., get_records_count() - 1) is the k'th generation written.
+
+HaplotypeFileReader gives random access to the haplotypes in a file 
+written by stream_populate_haplotypes(): the header "MALANHAP", 
+the format version, the population size and the number of loci (int32's), 
+and then the haplotypes individual by individual (int32's).
+*/
+class MappedFile {
+  private:
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+    bool m_mapped = false;
+    std::vector<char> m_buffer; // if not mapped
+    
+  public:
+    MappedFile(const std::string& filename);
+    ~MappedFile();
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    const char* data() const;
+    size_t size() const;
+};
+
+class GenerationFileReader {
+  private:
+    MappedFile m_file;
+    size_t m_population_size;
+    size_t m_records_count;
+    size_t m_record_size; // bytes
+    
+  public:
+    GenerationFileReader(const std::string& filename);
+    
+    size_t get_population_size() const;
+    size_t get_records_count() const;
+    int get_generation(size_t k) const;
+    const int* get_fathers(size_t k) const;
+};
+
+class HaplotypeFileReader {
+  private:
+    MappedFile m_file;
+    size_t m_population_size;
+    size_t m_loci;
+    
+  public:
+    HaplotypeFileReader(const std::string& filename);
+    
+    size_t get_population_size() const;
+    size_t get_loci() const;
+    const int* get_haplotype(size_t i) const;
+};
@@ -0,0 +1,106 @@
+/**
+ class_GenerationSink.cpp
+ Purpose: C++ class GenerationSink.
+ Details: C++ implementation.
+  
+ @author Mikkel Meyer Andersen
+ */
+
+#include "malan_types.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+/*****************************************
+FileGenerationSink
+******************************************/
+FileGenerationSink::FileGenerationSink(const std::string& filename, size_t population_size) {
+  m_file.open(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  
+  if (!m_file) {
+    throw std::invalid_argument("Could not open file for writing");
+  }
+  
+  int32_t header[2] = { GENERATION_SINK_FILE_VERSION, (int32_t)population_size };
+  m_file.write(GENERATION_SINK_FILE_MAGIC, 8);
+  m_file.write(reinterpret_cast<const char*>(header), sizeof(header));
+}
+
+void FileGenerationSink::consume(int generation, const std::vector<int>& fathers) {
+  int32_t g = generation;
+  m_file.write(reinterpret_cast<const char*>(&g), sizeof(g));
+  
+  static_assert(sizeof(int) == sizeof(int32_t), "int must be 32 bits");
+  m_file.write(reinterpret_cast<const char*>(fathers.data()), fathers.size()*sizeof(int32_t));
+  
+  if (!m_file) {
+    throw std::runtime_error("Could not write to file");
+  }
+}
+
+void FileGenerationSink::finish() {
+  m_file.close();
+  
+  if (m_file.fail()) {
+    throw std::runtime_error("Could not write to file");
+  }
+}
+
+
+/*****************************************
+SummaryGenerationSink
+******************************************/
+void SummaryGenerationSink::consume(int generation, const std::vector<int>& fathers) {
+  m_children_count.assign(fathers.size(), 0);
+  
+  int children_drawn = 0;
+  int distinct_fathers = 0;
+  int max_children = 0;
+  double children_sq = 0.0; // sum of squared number of children
+  
+  for (auto father_i : fathers) {
+    if (father_i < 0) {
+      continue;
+    }
+    
+    children_drawn += 1;
+    
+    int children = ++m_children_count[father_i];
+    
+    if (children == 1) {
+      distinct_fathers += 1;
+    }
+    
+    max_children = std::max(max_children, children);
+    children_sq += 2*children - 1; // c^2 - (c - 1)^2
+  }
+  
+  m_generation.push_back(generation);
+  m_children.push_back(children_drawn);
+  m_fathers.push_back(distinct_fathers);
+  m_max_children.push_back(max_children);
+  
+  double men = (double)fathers.size();
+  double children_mean = (double)children_drawn / men;
+  m_offspring_var.push_back(children_sq / men - children_mean*children_mean);
+}
+
+const std::vector<int>& SummaryGenerationSink::get_generation() const {
+  return m_generation;
+}
+
+const std::vector<int>& SummaryGenerationSink::get_children() const {
+  return m_children;
+}
+
+const std::vector<int>& SummaryGenerationSink::get_fathers() const {
+  return m_fathers;
+}
+
+const std::vector<int>& SummaryGenerationSink::get_max_children() const {
+  return m_max_children;
+}
+
+const std::vector<double>& SummaryGenerationSink::get_offspring_var() const {
+  return m_offspring_var;
+}
@@ -0,0 +1,67 @@
+/**
+ class_GenerationSink.h
+ Purpose: Header for C++ class GenerationSink.
+ Details: C++ header.
+  
+ @author Mikkel Meyer Andersen
+ */
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#define GENERATION_SINK_FILE_MAGIC "MALANGEN"
+#define GENERATION_SINK_FILE_VERSION 1
+
+/*
+GenerationSink consumes a streamed simulation (see sample_geneology_stream()) 
+one generation at a time: fathers[i] is the index of the father 
+(in generation `generation`) of individual i in generation `generation - 1`, 
+or -1 if individual i has no descendants in the end generation (generation 0) 
+and hence no father was drawn. The vector is only valid during the call.
+
+FileGenerationSink writes the generations to a binary file: 
+the header "MALANGEN", the format version and the population size 
+(int32's), and then for each generation the generation number 
+followed by the population size father indices (int32's, native byte order).
+
+SummaryGenerationSink keeps a few statistics per generation in memory 
+(computed online, so O(1) memory per generation).
+*/
+class GenerationSink {
+  public:
+    virtual ~GenerationSink() {}
+    virtual void consume(int generation, const std::vector<int>& fathers) = 0;
+    virtual void finish() {}
+};
+
+class FileGenerationSink: public GenerationSink {
+  private:
+    std::ofstream m_file;
+    
+  public:
+    FileGenerationSink(const std::string& filename, size_t population_size);
+    void consume(int generation, const std::vector<int>& fathers);
+    void finish();
+};
+
+class SummaryGenerationSink: public GenerationSink {
+  private:
+    std::vector<int> m_generation;
+    std::vector<int> m_children; // individuals with a father drawn
+    std::vector<int> m_fathers; // distinct fathers
+    std::vector<int> m_max_children;
+    std::vector<double> m_offspring_var; // variance of number of children over all men
+    
+    std::vector<int> m_children_count; // per father, reused
+    
+  public:
+    void consume(int generation, const std::vector<int>& fathers);
+    
+    const std::vector<int>& get_generation() const;
+    const std::vector<int>& get_children() const;
+    const std::vector<int>& get_fathers() const;
+    const std::vector<int>& get_max_children() const;
+    const std::vector<double>& get_offspring_var() const;
+};
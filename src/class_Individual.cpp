@@ -21,11 +21,10 @@ Individual::Individual(int pid, int generation) {
   m_pid = pid;
   m_generation = generation;
   
-  m_children = new std::vector<Individual*>();
-}
-
-Individual::~Individual() {
-  delete m_children;
+  m_dijkstra_visited = false;
+  m_haplotype_set = false;
+  m_haplotype_mutated = false;
+  m_mutations = 0;
 }
 
 int Individual::get_pid() const {
@@ -36,8 +35,24 @@ int Individual::get_generation() const {
   return m_generation;
 }
 
+int Individual::get_deme() const {
+  return m_deme;
+}
+
+void Individual::set_deme(int deme) {
+  m_deme = deme;
+}
+
 void Individual::add_child(Individual* child) {
-  m_children->push_back(child);
+  if (m_last_child == nullptr) {
+    child->m_next_brother = child;
+  } else {
+    child->m_next_brother = m_last_child->m_next_brother;
+    m_last_child->m_next_brother = child;
+  }
+  
+  m_last_child = child;
+  m_children_count += 1;
   child->m_father = this;
 }
 
@@ -45,12 +60,13 @@ Individual* Individual::get_father() const {
   return m_father;
 }
 
-std::vector<Individual*>* Individual::get_children() const {
-  return m_children;
+IndividualChildren Individual::get_children() const {
+  Individual* first_child = (m_last_child == nullptr) ? nullptr : m_last_child->m_next_brother;
+  return IndividualChildren(first_child, m_last_child, m_children_count);
 }
 
 int Individual::get_children_count() const {
-  return m_children->size();
+  return m_children_count;
 }
 
 bool Individual::pedigree_is_set() const {
@@ -88,7 +104,7 @@ void Individual::set_pedigree_id(int id, Pedigree* ped, int* pedigree_size) {
     m_father->set_pedigree_id(id, ped, pedigree_size);
   }
   
-  for (auto &child : (*m_children)) {
+  for (auto child : this->get_children()) {
     ped->add_relation(this, child);
     child->set_pedigree_id(id, ped, pedigree_size);
   }
@@ -143,8 +159,7 @@ void Individual::meiosis_dist_tree_internal(Individual* dest, int* dist) const {
     this->meiosis_dist_tree_internal(father, dist); 
   }
   
-  std::vector<Individual*>* children = dest->get_children();
-  for (auto child : *children) {
+  for (auto child : dest->get_children()) {
     child->dijkstra_tick_distance(m);
 
     this->meiosis_dist_tree_internal(child, dist);
@@ -187,7 +202,7 @@ int Individual::meiosis_dist_tree(Individual* dest) const {
 Father haplotype
 FIXME mutation_model?
 */
-void Individual::haplotype_mutate(std::vector<double>& mutation_rates) {
+void Individual::haplotype_mutate(std::vector<double>& mutation_rates, RNG* rng) {
   if (!m_haplotype_set) {
     throw std::invalid_argument("Father haplotype not set yet, so cannot mutate");
   }
@@ -199,19 +214,25 @@ void Individual::haplotype_mutate(std::vector<double>& mutation_rates) {
   }
   
   
+  int mutations = 0;
+  
   for (int loc = 0; loc < m_haplotype.size(); ++loc) {
-    if (R::runif(0.0, 1.0) < mutation_rates[loc]) {
-      if (R::runif(0.0, 1.0) < 0.5) {
+    if (rng->unif_rand() < mutation_rates[loc]) {
+      mutations += 1;
+      
+      if (rng->unif_rand() < 0.5) {
         m_haplotype[loc] = m_haplotype[loc] - 1;
       } else {
         m_haplotype[loc] = m_haplotype[loc] + 1;
       }
     }
   }
+  
+  this->set_mutations(mutations);
 }
 
 
-void Individual::haplotype_mutate_ladder_bounded(std::vector<double>& mutation_rates, std::vector<int>& ladder_min, std::vector<int>& ladder_max) {
+void Individual::haplotype_mutate_ladder_bounded(std::vector<double>& mutation_rates, std::vector<int>& ladder_min, std::vector<int>& ladder_max, RNG* rng) {
   if (!m_haplotype_set) {
     throw std::invalid_argument("Father haplotype not set yet, so cannot mutate");
   }
@@ -222,8 +243,12 @@ void Individual::haplotype_mutate_ladder_bounded(std::vector<double>& mutation_r
     throw std::invalid_argument("Father haplotype already set and mutated");
   }  
   
+  int mutations = 0;
+  
   for (int loc = 0; loc < m_haplotype.size(); ++loc) {
-    if (R::runif(0.0, 1.0) < mutation_rates[loc]) {
+    if (rng->unif_rand() < mutation_rates[loc]) {
+      mutations += 1;
+      
       // A mutation must happen:
       
       if (m_haplotype[loc] < ladder_min[loc]) {
@@ -264,7 +289,7 @@ void Individual::haplotype_mutate_ladder_bounded(std::vector<double>& mutation_r
       }
        else {
         // Somewhere on non-boundary ladder, choose direction
-        if (R::runif(0.0, 1.0) < 0.5) {
+        if (rng->unif_rand() < 0.5) {
           m_haplotype[loc] = m_haplotype[loc] - 1;
         } else {
           m_haplotype[loc] = m_haplotype[loc] + 1;
@@ -272,6 +297,8 @@ void Individual::haplotype_mutate_ladder_bounded(std::vector<double>& mutation_r
       }
     }
   }
+  
+  this->set_mutations(mutations);
 }
 
 
@@ -282,37 +309,54 @@ bool Individual::is_haplotype_set() const {
 void Individual::set_haplotype(std::vector<int> h) {
   m_haplotype = h;
   m_haplotype_set = true;
+  m_mutations = 0;
+}
+
+void Individual::unset_haplotype() {
+  m_haplotype.clear();
+  m_haplotype_set = false;
+  m_haplotype_mutated = false;
+  m_mutations = 0;
 }
 
 std::vector<int> Individual::get_haplotype() const {
   return m_haplotype;
 }
 
-void Individual::pass_haplotype_to_children(bool recursive, std::vector<double>& mutation_rates) {
-  for (auto &child : (*m_children)) {
+int Individual::get_mutations() const {
+  return m_mutations;
+}
+
+void Individual::set_mutations(int mutations) {
+  m_mutations = (mutations > UINT16_MAX) ? UINT16_MAX : mutations;
+}
+
+void Individual::pass_haplotype_to_children(bool recursive, std::vector<double>& mutation_rates, RNG* rng) {
+  for (auto child : this->get_children()) {
     child->set_haplotype(m_haplotype);
-    child->haplotype_mutate(mutation_rates);
+    child->haplotype_mutate(mutation_rates, rng);
     
     if (recursive) {
-      child->pass_haplotype_to_children(recursive, mutation_rates);
+      child->pass_haplotype_to_children(recursive, mutation_rates, rng);
     }
   }
 }
 
-void Individual::pass_haplotype_to_children_ladder_bounded(bool recursive, std::vector<double>& mutation_rates, std::vector<int>& ladder_min, std::vector<int>& ladder_max) {
-  for (auto &child : (*m_children)) {
+void Individual::pass_haplotype_to_children_ladder_bounded(bool recursive, std::vector<double>& mutation_rates, std::vector<int>& ladder_min, std::vector<int>& ladder_max, RNG* rng) {
+  for (auto child : this->get_children()) {
     child->set_haplotype(m_haplotype);
-    child->haplotype_mutate_ladder_bounded(mutation_rates, ladder_min, ladder_max);
+    child->haplotype_mutate_ladder_bounded(mutation_rates, ladder_min, ladder_max, rng);
     
     if (recursive) {
-      child->pass_haplotype_to_children_ladder_bounded(recursive, mutation_rates, ladder_min, ladder_max);
+      child->pass_haplotype_to_children_ladder_bounded(recursive, mutation_rates, ladder_min, ladder_max, rng);
     }
   }
 }
 
 int Individual::get_haplotype_L1(Individual* dest) const {
-  std::vector<int> h_this = this->get_haplotype();
-  std::vector<int> h_dest = dest->get_haplotype();
+  // no copies: called for many pairs
+  const std::vector<int>& h_this = m_haplotype;
+  const std::vector<int>& h_dest = dest->m_haplotype;
   
   if (h_this.size() != h_dest.size()) {
     Rcpp::Rcout << "this pid = " << this->get_pid() << " has haplotype with " << h_this.size() << " loci" << std::endl;
@@ -384,12 +428,12 @@ std::vector<Individual*> Individual::calculate_path_to(Individual* dest) const {
 }
 
 
-int possible_mutate_index(const int index, const double mutation_rate, const int max) {
+int possible_mutate_index(const int index, const double mutation_rate, const int max, RNG* rng) {
   if (max <= 0) {
     throw std::invalid_argument("max must be >= 1");
   }
   
-  if (R::runif(0.0, 1.0) >= mutation_rate) {
+  if (rng->unif_rand() >= mutation_rate) {
     // No mutation happened
     return index;
   }  
@@ -404,7 +448,7 @@ int possible_mutate_index(const int index, const double mutation_rate, const int
   }
 
   // Somewhere on non-boundary ladder, choose direction
-  if (R::runif(0.0, 1.0) < 0.5) {
+  if (rng->unif_rand() < 0.5) {
     return index - 1;
   } else {
     return index + 1;
@@ -413,10 +457,11 @@ int possible_mutate_index(const int index, const double mutation_rate, const int
 
 void Individual::pass_autosomal_to_children(bool recursive, 
     const std::vector< std::vector<double> >& allele_conditional_cumdists_theta,
-    const double mutation_rate) {
+    const double mutation_rate,
+    RNG* rng) {
 
   
-  for (auto &child : (*m_children)) {
+  for (auto child : this->get_children()) {
     /*
     We have theta, so the alleles in the child should be correlated.
     */
@@ -445,9 +490,9 @@ void Individual::pass_autosomal_to_children(bool recursive,
     */
     
     std::vector<int> geno_father = m_haplotype;
-    int father_allele = (R::runif(0.0, 1.0) < 0.5) ? geno_father[0] : geno_father[1];
+    int father_allele = (rng->unif_rand() < 0.5) ? geno_father[0] : geno_father[1];
     std::vector<double> cumdist = allele_conditional_cumdists_theta[father_allele];
-    double u = R::runif(0.0, 1.0);
+    double u = rng->unif_rand();
     int alleles_count = cumdist.size();
     int mother_allele = 0;
     
@@ -467,8 +512,8 @@ void Individual::pass_autosomal_to_children(bool recursive,
     // mutate:
     // m_haplotype has indices of alleles
     int max = alleles_count - 1; // index
-    geno[0] = possible_mutate_index(geno[0], mutation_rate, max);
-    geno[1] = possible_mutate_index(geno[1], mutation_rate, max);
+    geno[0] = possible_mutate_index(geno[0], mutation_rate, max, rng);
+    geno[1] = possible_mutate_index(geno[1], mutation_rate, max, rng);
     
     if (geno[1] <= geno[0]) {
       int tmp = geno[0];
@@ -479,7 +524,7 @@ void Individual::pass_autosomal_to_children(bool recursive,
     child->set_haplotype(geno);
     
     if (recursive) {
-      child->pass_autosomal_to_children(recursive, allele_conditional_cumdists_theta, mutation_rate);
+      child->pass_autosomal_to_children(recursive, allele_conditional_cumdists_theta, mutation_rate, rng);
     }
   }
 }
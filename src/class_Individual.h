@@ -10,36 +10,58 @@
 
 #include <vector>
 
+class IndividualChildren;
+
+/*
+The children of an individual are stored intrusively (no container per individual): 
+an individual points to his last child, and each child points to his next brother, 
+where the last child's next brother is the first child (a circular list), 
+so children are kept in the order added. 
+They are traversed by iterating IndividualChildren, e.g. 
+for (auto child : individual->get_children()) { ... }
+*/
 class Individual {
+  friend class IndividualChildIterator;
+  
 private:
+  /*
+  Fields are ordered by size (pointers, then the haplotype, then 32-bit fields, then flags) 
+  so there is no padding between them, and the flags are packed in a bitfield.
+  */
+  Individual* m_father = nullptr;
+  Individual* m_last_child = nullptr;
+  Individual* m_next_brother = nullptr; // circular: the last child's is the first child
+  Pedigree* m_pedigree = nullptr;
+  
+  std::vector<int> m_haplotype; // called haplotype, but is used without order for autosomal (as index of alleles)
+  
   int m_pid; 
   int m_generation = -1;
+  int m_deme = 0;
+  int m_children_count = 0;
+  int m_pedigree_id = 0;
+  int m_dijkstra_distance = 0;
   
-  std::vector<Individual*>* m_children = nullptr;
-  Individual* m_father = nullptr;
+  bool m_dijkstra_visited : 1;
+  bool m_haplotype_set : 1;
+  bool m_haplotype_mutated : 1;
   
-  Pedigree* m_pedigree = nullptr;
-  int m_pedigree_id = 0;
+  // mutations on the edge from the father when the haplotype was passed down (saturating)
+  uint16_t m_mutations;
   
   void meiosis_dist_tree_internal(Individual* dest, int* dist) const;
-  
-  bool m_dijkstra_visited = false;
-  int m_dijkstra_distance = 0;
-
-  std::vector<int> m_haplotype; // called haplotype, but is used without order for autosomal (as index of alleles)
-  bool m_haplotype_set = false;
-  bool m_haplotype_mutated = false;
-  void haplotype_mutate(std::vector<double>& mutation_rates);
-  void haplotype_mutate_ladder_bounded(std::vector<double>& mutation_rates, std::vector<int>& ladder_min, std::vector<int>& ladder_max);
+  void haplotype_mutate(std::vector<double>& mutation_rates, RNG* rng);
+  void haplotype_mutate_ladder_bounded(std::vector<double>& mutation_rates, std::vector<int>& ladder_min, std::vector<int>& ladder_max, RNG* rng);
   
 public:
   Individual(int pid, int generation);
-  ~Individual();
   int get_pid() const;
   int get_generation() const;
+  int get_deme() const;
+  void set_deme(int deme);
   void add_child(Individual* child);
   Individual* get_father() const;
-  std::vector<Individual*>* get_children() const;
+  IndividualChildren get_children() const;
   int get_children_count() const;
   bool pedigree_is_set() const;
   Pedigree* get_pedigree() const;
@@ -67,14 +89,70 @@ public:
   
   bool is_haplotype_set() const;
   void set_haplotype(std::vector<int> h);
+  void unset_haplotype();
   std::vector<int> get_haplotype() const;
-  void pass_haplotype_to_children(bool recursive, std::vector<double>& mutation_rates);
-  void pass_haplotype_to_children_ladder_bounded(bool recursive, std::vector<double>& mutation_rates, std::vector<int>& ladder_min, std::vector<int>& ladder_max);
+  int get_mutations() const;
+  void set_mutations(int mutations);
+  void pass_haplotype_to_children(bool recursive, std::vector<double>& mutation_rates, RNG* rng = get_R_rng());
+  void pass_haplotype_to_children_ladder_bounded(bool recursive, std::vector<double>& mutation_rates, std::vector<int>& ladder_min, std::vector<int>& ladder_max, RNG* rng = get_R_rng());
   
   int get_haplotype_L1(Individual* dest) const;
   
   void pass_autosomal_to_children(bool recursive, 
     const std::vector< std::vector<double> >& allele_conditional_cumdists_theta,
-    const double mutation_rate);
+    const double mutation_rate,
+    RNG* rng = get_R_rng());
 };
 
+class IndividualChildIterator {
+private:
+  Individual* m_child; // nullptr at end
+  Individual* m_last_child;
+  
+public:
+  IndividualChildIterator(Individual* child, Individual* last_child) : m_child(child), m_last_child(last_child) {}
+  
+  Individual* operator*() const { 
+    return m_child; 
+  }
+  
+  IndividualChildIterator& operator++() {
+    m_child = (m_child == m_last_child) ? nullptr : m_child->m_next_brother;
+    return *this;
+  }
+  
+  bool operator==(const IndividualChildIterator& other) const { 
+    return m_child == other.m_child; 
+  }
+  
+  bool operator!=(const IndividualChildIterator& other) const { 
+    return m_child != other.m_child; 
+  }
+};
+
+class IndividualChildren {
+private:
+  Individual* m_first_child;
+  Individual* m_last_child;
+  int m_size;
+  
+public:
+  IndividualChildren(Individual* first_child, Individual* last_child, int size) : 
+    m_first_child(first_child), m_last_child(last_child), m_size(size) {}
+  
+  IndividualChildIterator begin() const { 
+    return IndividualChildIterator(m_first_child, m_last_child); 
+  }
+  
+  IndividualChildIterator end() const { 
+    return IndividualChildIterator(nullptr, m_last_child); 
+  }
+  
+  int size() const { 
+    return m_size; 
+  }
+  
+  bool empty() const { 
+    return (m_size == 0); 
+  }
+};
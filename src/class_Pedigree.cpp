@@ -8,6 +8,8 @@
 
 #include "malan_types.h"
 
+#include <stdexcept>
+
 #include <RcppArmadillo.h> // FIXME: Avoid Rcpp here? Only in api_* files?
 
 /*
@@ -98,17 +100,35 @@ Individual* Pedigree::get_root() {
 }
 
 
-void Pedigree::populate_haplotypes(int loci, std::vector<double>& mutation_rates) {
+void Pedigree::populate_haplotypes(int loci, std::vector<double>& mutation_rates, RNG* rng) {
   /* FIXME: Exploits tree */
   Individual* root = this->get_root();
   
   std::vector<int> h(loci); // initialises to 0, 0, ..., 0
   
+  // at least one uniform per locus per non-root individual
+  rng->reserve((m_all_individuals->size() - 1) * mutation_rates.size());
+  
   root->set_haplotype(h);
-  root->pass_haplotype_to_children(true, mutation_rates);
+  root->pass_haplotype_to_children(true, mutation_rates, rng);
 }
 
-void Pedigree::populate_haplotypes_custom_founders(std::vector<double>& mutation_rates, Rcpp::Function get_founder_hap) {
+void Pedigree::populate_haplotypes_root_haplotype(const std::vector<int>& root_haplotype, std::vector<double>& mutation_rates, RNG* rng) {
+  /* FIXME: Exploits tree */
+  Individual* root = this->get_root();
+  
+  if (root_haplotype.size() != mutation_rates.size()) {
+    throw std::invalid_argument("Root haplotype must have the same number of loci as the number of mutation rates specified");
+  }
+  
+  // at least one uniform per locus per non-root individual
+  rng->reserve((m_all_individuals->size() - 1) * mutation_rates.size());
+  
+  root->set_haplotype(root_haplotype);
+  root->pass_haplotype_to_children(true, mutation_rates, rng);
+}
+
+void Pedigree::populate_haplotypes_custom_founders(std::vector<double>& mutation_rates, Rcpp::Function get_founder_hap, RNG* rng) {
   /* FIXME: Exploits tree */
   Individual* root = this->get_root();
   
@@ -124,11 +144,14 @@ void Pedigree::populate_haplotypes_custom_founders(std::vector<double>& mutation
   
   //Rf_PrintValue(Rcpp::wrap(h));
   
+  // after get_founder_hap() as it may use R's random number generator
+  rng->reserve((m_all_individuals->size() - 1) * mutation_rates.size());
+  
   root->set_haplotype(h);
-  root->pass_haplotype_to_children(true, mutation_rates);
+  root->pass_haplotype_to_children(true, mutation_rates, rng);
 }
 
-void Pedigree::populate_haplotypes_ladder_bounded(std::vector<double>& mutation_rates, std::vector<int>& ladder_min, std::vector<int>& ladder_max, Rcpp::Function get_founder_hap) {
+void Pedigree::populate_haplotypes_ladder_bounded(std::vector<double>& mutation_rates, std::vector<int>& ladder_min, std::vector<int>& ladder_max, Rcpp::Function get_founder_hap, RNG* rng) {
   if (mutation_rates.size() != ladder_min.size()) {
     Rcpp::stop("mutation_rates and ladder_min must have same length");
   }
@@ -154,8 +177,11 @@ void Pedigree::populate_haplotypes_ladder_bounded(std::vector<double>& mutation_
   
   //Rf_PrintValue(Rcpp::wrap(h));
   
+  // after get_founder_hap() as it may use R's random number generator
+  rng->reserve((m_all_individuals->size() - 1) * mutation_rates.size());
+  
   root->set_haplotype(h);
-  root->pass_haplotype_to_children_ladder_bounded(true, mutation_rates, ladder_min, ladder_max);
+  root->pass_haplotype_to_children_ladder_bounded(true, mutation_rates, ladder_min, ladder_max, rng);
 }
 
 
@@ -163,7 +189,8 @@ void Pedigree::populate_autosomal(
     const std::vector< std::vector<double> >& allele_conditional_cumdists_theta,
     const std::vector<double>& allele_cumdist_theta,
     const int alleles_count,
-    const double mutation_rate) {
+    const double mutation_rate, 
+    RNG* rng) {
   
   /* Exploits tree */
   Individual* root = this->get_root();
@@ -180,10 +207,13 @@ void Pedigree::populate_autosomal(
     Rcpp::stop("allele_conditional_cumdists_theta must have at least size 1");
   }
 
-  std::vector<int> h = draw_autosomal_genotype(allele_cumdist_theta, alleles_count);
+  // at least one uniform for the root and four per non-root individual
+  rng->reserve(1 + (m_all_individuals->size() - 1) * 4);
+  
+  std::vector<int> h = draw_autosomal_genotype(allele_cumdist_theta, alleles_count, rng);
   
   root->set_haplotype(h); // Not actually haplotype, but use this slot for lower memory footprint
-  root->pass_autosomal_to_children(true, allele_conditional_cumdists_theta, mutation_rate);
+  root->pass_autosomal_to_children(true, allele_conditional_cumdists_theta, mutation_rate, rng);
 }
 
 
@@ -30,18 +30,22 @@ public:
   
   Individual* get_root();
   
-  void populate_haplotypes(int loci, std::vector<double>& mutation_rates);
+  void populate_haplotypes(int loci, std::vector<double>& mutation_rates, RNG* rng = get_R_rng());
+  void populate_haplotypes_root_haplotype(const std::vector<int>& root_haplotype, std::vector<double>& mutation_rates, RNG* rng = get_R_rng());
   void populate_haplotypes_custom_founders(std::vector<double>& mutation_rates, 
-    Rcpp::Function get_founder_hap);
+    Rcpp::Function get_founder_hap, 
+    RNG* rng = get_R_rng());
   void populate_haplotypes_ladder_bounded(std::vector<double>& mutation_rates, 
     std::vector<int>& ladder_min, 
     std::vector<int>& ladder_max, 
-    Rcpp::Function get_founder_hap);
+    Rcpp::Function get_founder_hap, 
+    RNG* rng = get_R_rng());
   
   void populate_autosomal(
     const std::vector< std::vector<double> >& allele_conditional_cumdists_theta,
     const std::vector<double>& allele_cumdist_theta,
     const int alleles_count,
-    const double mutation_rate);
+    const double mutation_rate, 
+    RNG* rng = get_R_rng());
 };
 
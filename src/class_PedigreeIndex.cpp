@@ -0,0 +1,136 @@
+/**
+ class_PedigreeIndex.cpp
+ Purpose: C++ class PedigreeIndex.
+ Details: C++ implementation.
+  
+ @author Mikkel Meyer Andersen
+ */
+
+#include <RcppArmadillo.h>
+#include "malan_types.h"
+
+PedigreeIndex::PedigreeIndex(const std::vector<Pedigree*>& pedigrees) {
+  for (size_t p = 0; p < pedigrees.size(); ++p) {
+    m_pedigree_begin.push_back(m_individuals.size());
+    
+    // breadth first, m_individuals is used as the queue
+    size_t next = m_individuals.size();
+    Individual* root = pedigrees[p]->get_root();
+    m_index[root] = m_individuals.size();
+    m_individuals.push_back(root);
+    m_father.push_back(-1);
+    
+    while (next < m_individuals.size()) {
+      Individual* father = m_individuals[next];
+      
+      m_generation.push_back(father->get_generation());
+      m_pedigree.push_back(p);
+      
+      for (auto child : father->get_children()) {
+        m_index[child] = m_individuals.size();
+        m_individuals.push_back(child);
+        m_father.push_back(next);
+      }
+      
+      next += 1;
+    }
+  }
+  
+  m_pedigree_begin.push_back(m_individuals.size());
+}
+
+int PedigreeIndex::size() const {
+  return m_individuals.size();
+}
+
+int PedigreeIndex::get_pedigrees_count() const {
+  return m_pedigree_begin.size() - 1;
+}
+
+int PedigreeIndex::get_index(Individual* individual) const {
+  auto got = m_index.find(individual);
+  
+  if (got == m_index.end()) {
+    return -1;
+  }
+  
+  return got->second;
+}
+
+Individual* PedigreeIndex::get_individual(int i) const {
+  return m_individuals[i];
+}
+
+int PedigreeIndex::get_father(int i) const {
+  return m_father[i];
+}
+
+int PedigreeIndex::get_generation(int i) const {
+  return m_generation[i];
+}
+
+int PedigreeIndex::get_pedigree(int i) const {
+  return m_pedigree[i];
+}
+
+int PedigreeIndex::get_pedigree_begin(int p) const {
+  return m_pedigree_begin[p];
+}
+
+int PedigreeIndex::get_pedigree_end(int p) const {
+  return m_pedigree_begin[p + 1];
+}
+
+int PedigreeIndex::meiosis_dist(int i, int j) const {
+  if (m_pedigree[i] != m_pedigree[j]) {
+    return -1;
+  }
+  
+  // fathers have smaller indices than sons, so walk up from the largest index
+  int meioses = 0;
+  
+  while (i != j) {
+    if (i > j) {
+      i = m_father[i];
+    } else {
+      j = m_father[j];
+    }
+    
+    meioses += 1;
+  }
+  
+  return meioses;
+}
+
+void PedigreeIndex::populate_haplotypes(std::vector<int>& haplotypes, 
+                                        const std::vector<double>& mutation_rates, RNG* rng) const {
+  size_t loci = mutation_rates.size();
+  size_t n = m_individuals.size();
+  
+  haplotypes.resize(n * loci);
+  
+  for (size_t i = 0; i < n; ++i) {
+    int* h = &(haplotypes[i * loci]);
+    
+    if (m_father[i] == -1) {
+      std::fill(h, h + loci, 0);
+      continue;
+    }
+    
+    const int* h_father = &(haplotypes[m_father[i] * loci]);
+    
+    // as Individual::haplotype_mutate()
+    for (size_t loc = 0; loc < loci; ++loc) {
+      h[loc] = h_father[loc];
+      
+      if (rng->unif_rand() < mutation_rates[loc]) {
+        if (rng->unif_rand() < 0.5) {
+          h[loc] = h[loc] - 1;
+        } else {
+          h[loc] = h[loc] + 1;
+        }
+      }
+    }
+  }
+}
+
@@ -0,0 +1,55 @@
+/**
+ class_PedigreeIndex.h
+ Purpose: Header for C++ class PedigreeIndex.
+ Details: C++ header.
+  
+ @author Mikkel Meyer Andersen
+ */
+
+#include "malan_types.h"
+
+#include <vector>
+#include <unordered_map>
+
+/*
+PedigreeIndex is a compiled (flat) copy of the structure of a set of pedigrees:
+individuals are numbered 0, 1, ..., size() - 1 pedigree by pedigree, 
+and within a pedigree in breadth first order from the root, 
+such that a father always comes before his sons.
+
+It is built once (on the main thread, as Pedigree::get_root() may call R) 
+and is afterwards read-only, so it can be shared between worker threads 
+that each e.g. hold their own haplotype buffer.
+*/
+class PedigreeIndex {
+private:
+  std::vector<Individual*> m_individuals;
+  std::vector<int> m_father; // -1 for the root
+  std::vector<int> m_generation;
+  std::vector<int> m_pedigree;
+  std::vector<int> m_pedigree_begin; // pedigree p is [m_pedigree_begin[p], m_pedigree_begin[p + 1])
+  std::unordered_map<Individual*, int> m_index;
+  
+public:
+  PedigreeIndex(const std::vector<Pedigree*>& pedigrees);
+  
+  int size() const;
+  int get_pedigrees_count() const;
+  int get_index(Individual* individual) const; // -1 if not indexed
+  Individual* get_individual(int i) const;
+  int get_father(int i) const;
+  int get_generation(int i) const;
+  int get_pedigree(int i) const;
+  int get_pedigree_begin(int p) const;
+  int get_pedigree_end(int p) const;
+  
+  int meiosis_dist(int i, int j) const;
+  
+  /*
+  Haplotypes as in Pedigree::populate_haplotypes() (root gets 0, 0, ..., 0), 
+  stored in haplotypes (individual i's haplotype is at [i*loci, (i+1)*loci)).
+  */
+  void populate_haplotypes(std::vector<int>& haplotypes, 
+    const std::vector<double>& mutation_rates, RNG* rng) const;
+};
+
@@ -12,6 +12,8 @@
 // [[Rcpp::depends(RcppProgress)]]
 #include <progress.hpp>
 
+#include <algorithm>
+
 /*
 ==========================================
 Individual
@@ -62,3 +64,58 @@ Individual* Population::get_individual(int pid) const {
 int Population::get_population_size() const {
   return m_population->size();
 }
+
+void Population::index_generations() {
+  if (m_generation_index_valid && m_generation_index_size == m_population->size()) {
+    return;
+  }
+  
+  std::vector< std::pair<int, int> > generation_pid;
+  generation_pid.reserve(m_population->size());
+  
+  for (auto it = m_population->begin(); it != m_population->end(); ++it) {
+    generation_pid.push_back(std::make_pair(it->second->get_generation(), it->first));
+  }
+  
+  std::sort(generation_pid.begin(), generation_pid.end());
+  
+  m_pids_by_generation.resize(generation_pid.size());
+  m_generation_end.clear();
+  
+  for (size_t i = 0; i < generation_pid.size(); ++i) {
+    int generation = generation_pid[i].first;
+    m_pids_by_generation[i] = generation_pid[i].second;
+    
+    // individuals without a generation (-1) come first and are in every prefix
+    while (generation >= 0 && (int)m_generation_end.size() < generation) {
+      m_generation_end.push_back(i);
+    }
+    
+    if (generation >= 0) {
+      m_generation_end.resize(generation + 1, 0);
+      m_generation_end[generation] = i + 1;
+    }
+  }
+  
+  m_generation_index_size = m_population->size();
+  m_generation_index_valid = true;
+}
+
+const std::vector<int>& Population::get_pids_by_generation() {
+  this->index_generations();
+  return m_pids_by_generation;
+}
+
+size_t Population::get_generation_end(int generation_upper_bound) {
+  this->index_generations();
+  
+  if (generation_upper_bound == -1 || (size_t)generation_upper_bound >= m_generation_end.size()) {
+    return m_pids_by_generation.size();
+  }
+  
+  return m_generation_end[generation_upper_bound];
+}
+
+void Population::invalidate_generation_index() {
+  m_generation_index_valid = false;
+}
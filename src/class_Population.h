@@ -14,6 +14,18 @@
 class Population {
 private:
   std::unordered_map<int, Individual*>* m_population = NULL;
+  
+  /*
+  Index by generation (built when first needed, e.g. by sample_pids()): 
+  pids sorted by generation and then pid, so generation 0, 1, ..., g is a prefix, 
+  ending at m_generation_end[g]. Rebuilt if individuals have been added since.
+  */
+  std::vector<int> m_pids_by_generation;
+  std::vector<size_t> m_generation_end;
+  size_t m_generation_index_size = 0;
+  bool m_generation_index_valid = false;
+  
+  void index_generations();
 
 public:
   Population(std::unordered_map<int, Individual*>* population);
@@ -21,6 +33,14 @@ public:
   std::unordered_map<int, Individual*>* get_population() const;
   int get_population_size() const;
   Individual* get_individual(int pid) const;
+  
+  // pids sorted by generation (then pid); those in generation 0, 1, ..., generation_upper_bound
+  // are the first get_generation_end(generation_upper_bound) (-1 means all)
+  const std::vector<int>& get_pids_by_generation();
+  size_t get_generation_end(int generation_upper_bound);
+  
+  // must be called when individuals are added to the population
+  void invalidate_generation_index();
 };
 
 
@@ -0,0 +1,241 @@
+/**
+ class_PopulationSnapshot.cpp
+ Purpose: C++ class PopulationSnapshot.
+ Details: C++ implementation.
+
+ @author Mikkel Meyer Andersen
+ */
+
+#include "malan_types.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+PopulationSnapshot::PopulationSnapshot(const std::unordered_map<int, Individual*>& population,
+                                       int generation_upper_bound_in_result) : m_loci(0) {
+
+  std::vector<Individual*> individuals;
+
+  for (auto it = population.begin(); it != population.end(); ++it) {
+    Individual* indv = it->second;
+
+    if (generation_upper_bound_in_result != -1 && indv->get_generation() > generation_upper_bound_in_result) {
+      continue;
+    }
+
+    if (!indv->pedigree_is_set()) {
+      throw std::invalid_argument("Pedigrees have not been built");
+    }
+
+    if (!indv->is_haplotype_set()) {
+      throw std::invalid_argument("Haplotypes have not been populated");
+    }
+
+    individuals.push_back(indv);
+  }
+
+  size_t n = individuals.size();
+
+  if (n > 0) {
+    m_loci = individuals[0]->get_haplotype().size();
+  }
+
+  // haplotypes in the order of individuals, then rows are sorted
+  std::vector<int> haplotypes(n * m_loci);
+
+  for (size_t i = 0; i < n; ++i) {
+    std::vector<int> h = individuals[i]->get_haplotype();
+
+    if (h.size() != m_loci) {
+      throw std::invalid_argument("All haplotypes must have the same number of loci");
+    }
+
+    std::copy(h.begin(), h.end(), haplotypes.begin() + i*m_loci);
+  }
+
+  std::vector<int> order(n);
+
+  for (size_t i = 0; i < n; ++i) {
+    order[i] = i;
+  }
+
+  std::sort(order.begin(), order.end(), [&](int a, int b) {
+    Individual* indv_a = individuals[a];
+    Individual* indv_b = individuals[b];
+
+    if (indv_a->get_pedigree_id() != indv_b->get_pedigree_id()) {
+      return indv_a->get_pedigree_id() < indv_b->get_pedigree_id();
+    }
+
+    const int* h_a = haplotypes.data() + (size_t)a*m_loci;
+    const int* h_b = haplotypes.data() + (size_t)b*m_loci;
+
+    if (!std::equal(h_a, h_a + m_loci, h_b)) {
+      return std::lexicographical_compare(h_a, h_a + m_loci, h_b, h_b + m_loci);
+    }
+
+    return indv_a->get_pid() < indv_b->get_pid();
+  });
+
+  m_pid.resize(n);
+  m_generation.resize(n);
+  m_pedigree_id.resize(n);
+  m_father_pid.resize(n);
+  m_father_row.resize(n);
+  m_haplotypes.resize(n * m_loci);
+  m_fingerprint.resize(n);
+  m_by_fingerprint.resize(n);
+
+  for (size_t r = 0; r < n; ++r) {
+    Individual* indv = individuals[order[r]];
+    const int* h = haplotypes.data() + (size_t)order[r]*m_loci;
+
+    m_pid[r] = indv->get_pid();
+    m_generation[r] = indv->get_generation();
+    m_pedigree_id[r] = indv->get_pedigree_id();
+    m_father_pid[r] = (indv->get_father() == nullptr) ? 0 : indv->get_father()->get_pid();
+    std::copy(h, h + m_loci, m_haplotypes.begin() + r*m_loci);
+    m_fingerprint[r] = fingerprint(h, m_loci);
+    m_by_fingerprint[r] = std::make_pair(m_fingerprint[r], (int)r);
+    m_row_of_pid[m_pid[r]] = r;
+  }
+
+  for (size_t r = 0; r < n; ++r) {
+    m_father_row[r] = (m_father_pid[r] == 0) ? -1 : get_row(m_father_pid[r]);
+  }
+
+  std::sort(m_by_fingerprint.begin(), m_by_fingerprint.end());
+}
+
+// FNV-1a over the bytes of the alleles
+uint64_t PopulationSnapshot::fingerprint(const int* haplotype, size_t loci) {
+  uint64_t h = 14695981039346656037ULL;
+
+  for (size_t loc = 0; loc < loci; ++loc) {
+    uint32_t a = (uint32_t)haplotype[loc];
+
+    for (int b = 0; b < 4; ++b) {
+      h ^= (a >> (8*b)) & 0xFF;
+      h *= 1099511628211ULL;
+    }
+  }
+
+  return h;
+}
+
+size_t PopulationSnapshot::size() const {
+  return m_pid.size();
+}
+
+size_t PopulationSnapshot::get_loci() const {
+  return m_loci;
+}
+
+int PopulationSnapshot::get_row(int pid) const {
+  auto got = m_row_of_pid.find(pid);
+
+  if (got == m_row_of_pid.end()) {
+    return -1;
+  }
+
+  return got->second;
+}
+
+int PopulationSnapshot::get_pid(int row) const {
+  return m_pid[row];
+}
+
+int PopulationSnapshot::get_generation(int row) const {
+  return m_generation[row];
+}
+
+int PopulationSnapshot::get_pedigree_id(int row) const {
+  return m_pedigree_id[row];
+}
+
+int PopulationSnapshot::get_father_pid(int row) const {
+  return m_father_pid[row];
+}
+
+int PopulationSnapshot::get_father_row(int row) const {
+  return m_father_row[row];
+}
+
+const int* PopulationSnapshot::get_haplotype(int row) const {
+  return m_haplotypes.data() + (size_t)row*m_loci;
+}
+
+uint64_t PopulationSnapshot::get_fingerprint(int row) const {
+  return m_fingerprint[row];
+}
+
+bool PopulationSnapshot::haplotype_equals(int row, const int* haplotype) const {
+  const int* h = get_haplotype(row);
+  return std::equal(h, h + m_loci, haplotype);
+}
+
+bool PopulationSnapshot::haplotype_less(int row, const int* haplotype) const {
+  const int* h = get_haplotype(row);
+  return std::lexicographical_compare(h, h + m_loci, haplotype, haplotype + m_loci);
+}
+
+void PopulationSnapshot::pedigree_rows(int pedigree_id, int* begin, int* end) const {
+  auto range = std::equal_range(m_pedigree_id.begin(), m_pedigree_id.end(), pedigree_id);
+  *begin = range.first - m_pedigree_id.begin();
+  *end = range.second - m_pedigree_id.begin();
+}
+
+void PopulationSnapshot::pedigree_haplotype_rows(int pedigree_id, const int* haplotype, int* begin, int* end) const {
+  int ped_begin = 0;
+  int ped_end = 0;
+  pedigree_rows(pedigree_id, &ped_begin, &ped_end);
+
+  // within a pedigree, rows are sorted by haplotype
+  int lo = ped_begin;
+  int hi = ped_end;
+
+  while (lo < hi) {
+    int mid = lo + (hi - lo)/2;
+
+    if (haplotype_less(mid, haplotype)) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  *begin = lo;
+  *end = lo;
+
+  while (*end < ped_end && haplotype_equals(*end, haplotype)) {
+    *end += 1;
+  }
+}
+
+void PopulationSnapshot::matches(const int* haplotype, std::vector<int>& rows) const {
+  rows.clear();
+
+  uint64_t f = fingerprint(haplotype, m_loci);
+  auto it = std::lower_bound(m_by_fingerprint.begin(), m_by_fingerprint.end(), std::make_pair(f, -1));
+
+  // different haplotypes can have the same fingerprint
+  for (; it != m_by_fingerprint.end() && it->first == f; ++it) {
+    if (haplotype_equals(it->second, haplotype)) {
+      rows.push_back(it->second);
+    }
+  }
+}
+
+int PopulationSnapshot::count_matches(const int* haplotype) const {
+  uint64_t f = fingerprint(haplotype, m_loci);
+  auto it = std::lower_bound(m_by_fingerprint.begin(), m_by_fingerprint.end(), std::make_pair(f, -1));
+  int count = 0;
+
+  for (; it != m_by_fingerprint.end() && it->first == f; ++it) {
+    if (haplotype_equals(it->second, haplotype)) {
+      count += 1;
+    }
+  }
+
+  return count;
+}
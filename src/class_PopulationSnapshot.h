@@ -0,0 +1,68 @@
+/**
+ class_PopulationSnapshot.h
+ Purpose: Header for C++ class PopulationSnapshot.
+ Details: C++ header.
+
+ @author Mikkel Meyer Andersen
+ */
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/*
+PopulationSnapshot is a frozen copy of the individuals in the most recent generations
+(0, 1, ..., generation_upper_bound_in_result) of a population stored column by column:
+pid, generation, pedigree id, father's pid (0 if none), haplotype (loci per row) and
+a fingerprint (hash) of the haplotype.
+Rows are sorted by pedigree id, then haplotype and then pid, so the individuals
+in a pedigree with the same haplotype are contiguous.
+
+It does not refer to the individuals, so it stays valid if the population is changed or deleted,
+and it is read-only (and does not call R) after it has been built.
+*/
+class PopulationSnapshot {
+  private:
+    size_t m_loci;
+    std::vector<int> m_pid;
+    std::vector<int> m_generation;
+    std::vector<int> m_pedigree_id;
+    std::vector<int> m_father_pid;
+    std::vector<int> m_father_row; // -1 if the father is not in the snapshot
+    std::vector<int> m_haplotypes; // row r's haplotype is at [r*loci, (r+1)*loci)
+    std::vector<uint64_t> m_fingerprint;
+
+    std::vector< std::pair<uint64_t, int> > m_by_fingerprint; // (fingerprint, row), sorted
+    std::unordered_map<int, int> m_row_of_pid;
+
+    bool haplotype_equals(int row, const int* haplotype) const;
+    bool haplotype_less(int row, const int* haplotype) const;
+
+  public:
+    PopulationSnapshot(const std::unordered_map<int, Individual*>& population, int generation_upper_bound_in_result);
+
+    static uint64_t fingerprint(const int* haplotype, size_t loci);
+
+    size_t size() const;
+    size_t get_loci() const;
+    int get_row(int pid) const; // -1 if not in the snapshot
+
+    int get_pid(int row) const;
+    int get_generation(int row) const;
+    int get_pedigree_id(int row) const;
+    int get_father_pid(int row) const;
+    int get_father_row(int row) const;
+    const int* get_haplotype(int row) const;
+    uint64_t get_fingerprint(int row) const;
+
+    // rows [*begin, *end) in the pedigree
+    void pedigree_rows(int pedigree_id, int* begin, int* end) const;
+
+    // rows [*begin, *end) in the pedigree with the haplotype
+    void pedigree_haplotype_rows(int pedigree_id, const int* haplotype, int* begin, int* end) const;
+
+    // rows with the haplotype (by fingerprint, in order of rows)
+    void matches(const int* haplotype, std::vector<int>& rows) const;
+    int count_matches(const int* haplotype) const;
+};
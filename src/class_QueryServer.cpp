@@ -0,0 +1,591 @@
+/**
+ class_QueryServer.cpp
+ Purpose: C++ classes answering queries on pedigrees over a local socket.
+ Details: C++ implementation.
+
+ @author Mikkel Meyer Andersen
+ */
+
+#include "malan_types.h"
+
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+// on the server, a request that has started must be completed within this time
+// (the client waits for the response as long as it takes)
+#define QUERY_REQUEST_TIMEOUT_SECONDS 10
+
+/*****************************************
+QueryEngine
+******************************************/
+QueryEngine::QueryEngine(const std::vector<Pedigree*>& pedigrees, int generation_upper_bound_in_result) :
+  m_index(pedigrees), m_loci(0), m_match_individuals(0) {
+
+  size_t n = m_index.size();
+
+  for (size_t i = 0; i < n; ++i) {
+    Individual* indv = m_index.get_individual(i);
+
+    if (!indv->is_haplotype_set()) {
+      throw std::invalid_argument("Haplotypes have not been populated");
+    }
+
+    std::vector<int> h = indv->get_haplotype();
+
+    if (i == 0) {
+      m_loci = h.size();
+      m_haplotypes.reserve(n * m_loci);
+    } else if (h.size() != m_loci) {
+      throw std::invalid_argument("All haplotypes must have the same number of loci");
+    }
+
+    m_haplotypes.insert(m_haplotypes.end(), h.begin(), h.end());
+    m_pid_index[indv->get_pid()] = i;
+
+    if (generation_upper_bound_in_result == -1 || m_index.get_generation(i) <= generation_upper_bound_in_result) {
+      m_match_counts[h] += 1;
+      m_match_individuals += 1;
+    }
+  }
+}
+
+size_t QueryEngine::get_loci() const {
+  return m_loci;
+}
+
+int QueryEngine::index_of(int pid) const {
+  auto got = m_pid_index.find(pid);
+
+  if (got == m_pid_index.end()) {
+    return -1;
+  }
+
+  return got->second;
+}
+
+int QueryEngine::haplotype_L1(int i, int j) const {
+  const int* h1 = m_haplotypes.data() + (size_t)i*m_loci;
+  const int* h2 = m_haplotypes.data() + (size_t)j*m_loci;
+  int d = 0;
+
+  for (size_t loc = 0; loc < m_loci; ++loc) {
+    d += std::abs(h1[loc] - h2[loc]);
+  }
+
+  return d;
+}
+
+long QueryEngine::request_words(int type, int count) const {
+  if (count < 0) {
+    return -1;
+  }
+
+  switch (type) {
+    case QUERY_INFO:
+    case QUERY_SHUTDOWN:
+      return (count == 0) ? 0 : -1;
+    case QUERY_MATCH_COUNTS:
+      return (long)count * (long)m_loci;
+    case QUERY_RELATIVES:
+    case QUERY_DISTANCES:
+      return 2L * (long)count;
+  }
+
+  return -1;
+}
+
+int QueryEngine::answer(int type, int count, const std::vector<int32_t>& queries, std::vector<int32_t>& response) const {
+  response.clear();
+
+  if (type == QUERY_INFO || type == QUERY_SHUTDOWN) {
+    if (type == QUERY_INFO) {
+      response.push_back(m_loci);
+      response.push_back(m_match_individuals);
+    }
+
+    return QUERY_STATUS_OK;
+  }
+
+  if (type == QUERY_MATCH_COUNTS) {
+    std::vector<int> h(m_loci);
+
+    for (int q = 0; q < count; ++q) {
+      std::copy(queries.begin() + (size_t)q*m_loci, queries.begin() + (size_t)(q + 1)*m_loci, h.begin());
+      auto got = m_match_counts.find(h);
+      response.push_back((got == m_match_counts.end()) ? 0 : got->second);
+    }
+
+    return QUERY_STATUS_OK;
+  }
+
+  if (type == QUERY_RELATIVES) {
+    for (int q = 0; q < count; ++q) {
+      int i = index_of(queries[2*q]);
+      int max_L1 = queries[2*q + 1];
+
+      if (i == -1) {
+        response.clear();
+        return QUERY_STATUS_UNKNOWN_PID;
+      }
+
+      // number of relatives, filled in below
+      size_t m_pos = response.size();
+      response.push_back(0);
+
+      int p = m_index.get_pedigree(i);
+
+      for (int j = m_index.get_pedigree_begin(p); j < m_index.get_pedigree_end(p); ++j) {
+        if (j == i) {
+          continue;
+        }
+
+        int d = haplotype_L1(i, j);
+
+        if (d <= max_L1) {
+          response.push_back(m_index.get_individual(j)->get_pid());
+          response.push_back(m_index.meiosis_dist(i, j));
+          response.push_back(d);
+          response[m_pos] += 1;
+        }
+      }
+    }
+
+    return QUERY_STATUS_OK;
+  }
+
+  if (type == QUERY_DISTANCES) {
+    for (int q = 0; q < count; ++q) {
+      int i = index_of(queries[2*q]);
+      int j = index_of(queries[2*q + 1]);
+
+      if (i == -1 || j == -1) {
+        response.clear();
+        return QUERY_STATUS_UNKNOWN_PID;
+      }
+
+      response.push_back(m_index.meiosis_dist(i, j));
+      response.push_back(haplotype_L1(i, j));
+    }
+
+    return QUERY_STATUS_OK;
+  }
+
+  return QUERY_STATUS_BAD_REQUEST;
+}
+
+#ifndef _WIN32
+/*****************************************
+Socket helpers
+******************************************/
+static bool read_all(int fd, void* buffer, size_t bytes) {
+  char* p = static_cast<char*>(buffer);
+
+  while (bytes > 0) {
+    ssize_t r = recv(fd, p, bytes, 0);
+
+    if (r <= 0) {
+      return false;
+    }
+
+    p += r;
+    bytes -= r;
+  }
+
+  return true;
+}
+
+static bool write_all(int fd, const void* buffer, size_t bytes) {
+  const char* p = static_cast<const char*>(buffer);
+  int flags = 0;
+
+#ifdef MSG_NOSIGNAL
+  // a client that has gone away must not kill the server by SIGPIPE
+  flags = MSG_NOSIGNAL;
+#endif
+
+  while (bytes > 0) {
+    ssize_t r = send(fd, p, bytes, flags);
+
+    if (r <= 0) {
+      return false;
+    }
+
+    p += r;
+    bytes -= r;
+  }
+
+  return true;
+}
+
+static void set_socket_options(int fd, bool timeouts) {
+#ifdef SO_NOSIGPIPE
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+
+  if (!timeouts) {
+    return;
+  }
+
+  struct timeval timeout;
+  timeout.tv_sec = QUERY_REQUEST_TIMEOUT_SECONDS;
+  timeout.tv_usec = 0;
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
+
+static struct sockaddr_un socket_address(const std::string& path) {
+  struct sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+
+  if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+    throw std::invalid_argument("Socket path must be non-empty and shorter than " +
+                                std::to_string(sizeof(address.sun_path)) + " characters");
+  }
+
+  std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+  return address;
+}
+
+static int connect_socket(const std::string& path) {
+  struct sockaddr_un address = socket_address(path);
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+  if (fd == -1) {
+    throw std::runtime_error("Could not create socket");
+  }
+
+  if (connect(fd, (struct sockaddr*)&address, sizeof(address)) == -1) {
+    close(fd);
+    return -1;
+  }
+
+  return fd;
+}
+
+/*****************************************
+QueryServer
+******************************************/
+QueryServer::QueryServer(const QueryEngine& engine, const std::string& path) :
+  m_engine(engine), m_path(path) {
+
+  struct sockaddr_un address = socket_address(path);
+
+  // a socket left by a server that is no longer running is removed
+  struct stat st;
+
+  if (stat(path.c_str(), &st) == 0) {
+    if (!S_ISSOCK(st.st_mode)) {
+      throw std::invalid_argument("Socket path exists and is not a socket");
+    }
+
+    int fd = connect_socket(path);
+
+    if (fd != -1) {
+      close(fd);
+      throw std::invalid_argument("A server is already running on the socket");
+    }
+
+    unlink(path.c_str());
+  }
+
+  m_listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+  if (m_listen_fd == -1) {
+    throw std::runtime_error("Could not create socket");
+  }
+
+  if (bind(m_listen_fd, (struct sockaddr*)&address, sizeof(address)) == -1 || listen(m_listen_fd, SOMAXCONN) == -1) {
+    close(m_listen_fd);
+    throw std::runtime_error("Could not listen on socket");
+  }
+}
+
+QueryServer::~QueryServer() {
+  if (m_listen_fd != -1) {
+    close(m_listen_fd);
+    unlink(m_path.c_str());
+  }
+}
+
+int QueryServer::serve_request(int fd, std::vector<int32_t>& queries, std::vector<int32_t>& response) const {
+  int32_t header[2];
+
+  if (!read_all(fd, header, sizeof(header))) {
+    return QUERY_CONNECTION_CLOSE;
+  }
+
+  long words = m_engine.request_words(header[0], header[1]);
+  int32_t response_header[2] = { QUERY_STATUS_BAD_REQUEST, 0 };
+
+  // the rest of the request cannot be skipped, so the connection is closed
+  if (words < 0 || words > QUERY_MAX_WORDS) {
+    write_all(fd, response_header, sizeof(response_header));
+    return QUERY_CONNECTION_CLOSE;
+  }
+
+  queries.resize(words);
+
+  if (!read_all(fd, queries.data(), words * sizeof(int32_t))) {
+    return QUERY_CONNECTION_CLOSE;
+  }
+
+  response_header[0] = m_engine.answer(header[0], header[1], queries, response);
+
+  // the number of words must fit in the header
+  if (response.size() > (size_t)INT32_MAX) {
+    response_header[0] = QUERY_STATUS_RESPONSE_TOO_LARGE;
+    response.clear();
+  }
+
+  response_header[1] = response.size();
+
+  if (!write_all(fd, response_header, sizeof(response_header)) ||
+      !write_all(fd, response.data(), response.size() * sizeof(int32_t))) {
+    return QUERY_CONNECTION_CLOSE;
+  }
+
+  return (header[0] == QUERY_SHUTDOWN) ? QUERY_CONNECTION_SHUTDOWN : QUERY_CONNECTION_KEEP;
+}
+
+void QueryServer::run(int threads, bool (*should_stop)(), int poll_ms) {
+  std::mutex mutex;
+  std::condition_variable pending_available;
+  std::deque<int> pending;  // connections with a request, waiting for a worker
+  std::vector<int> returned; // connections whose request has been answered, back to idle
+  std::atomic<bool> stop(false);
+  std::vector<std::thread> workers;
+
+  // workers wake the polling thread (to poll returned connections) by writing to this pipe
+  int wake[2];
+
+  if (pipe(wake) == -1) {
+    throw std::runtime_error("Could not create pipe");
+  }
+
+  // workers must not block on a full pipe (the polling thread is then awake anyway)
+  fcntl(wake[1], F_SETFL, O_NONBLOCK);
+
+  for (int t = 0; t < threads; ++t) {
+    workers.push_back(std::thread([&]() {
+      std::vector<int32_t> queries;
+      std::vector<int32_t> response;
+
+      while (true) {
+        int fd = -1;
+
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          pending_available.wait(lock, [&]() { return stop || !pending.empty(); });
+
+          if (stop) {
+            return;
+          }
+
+          fd = pending.front();
+          pending.pop_front();
+        }
+
+        int result = serve_request(fd, queries, response);
+
+        if (result == QUERY_CONNECTION_KEEP) {
+          std::lock_guard<std::mutex> lock(mutex);
+          returned.push_back(fd);
+        } else {
+          close(fd);
+        }
+
+        if (result == QUERY_CONNECTION_SHUTDOWN) {
+          stop = true;
+        }
+
+        char c = 0;
+        ssize_t w = write(wake[1], &c, 1);
+        (void)w;
+      }
+    }));
+  }
+
+  // this thread accepts connections and polls the idle ones for requests
+  // (and checks should_stop, which may call R)
+  std::vector<int> idle;
+  std::vector<struct pollfd> polled;
+
+  while (!stop && !should_stop()) {
+    polled.resize(2 + idle.size());
+    polled[0].fd = m_listen_fd;
+    polled[1].fd = wake[0];
+
+    for (size_t k = 0; k < idle.size(); ++k) {
+      polled[2 + k].fd = idle[k];
+    }
+
+    for (auto& p : polled) {
+      p.events = POLLIN;
+      p.revents = 0;
+    }
+
+    if (poll(polled.data(), polled.size(), poll_ms) <= 0) {
+      continue;
+    }
+
+    if (polled[1].revents != 0) {
+      char buffer[64];
+      ssize_t r = read(wake[0], buffer, sizeof(buffer));
+      (void)r;
+    }
+
+    // idle connections with a request (or closed) go to the workers
+    std::vector<int> still_idle;
+    bool any_pending = false;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+
+      for (size_t k = 0; k < idle.size(); ++k) {
+        if (polled[2 + k].revents != 0) {
+          pending.push_back(idle[k]);
+          any_pending = true;
+        } else {
+          still_idle.push_back(idle[k]);
+        }
+      }
+
+      still_idle.insert(still_idle.end(), returned.begin(), returned.end());
+      returned.clear();
+    }
+
+    idle.swap(still_idle);
+
+    if (any_pending) {
+      pending_available.notify_all();
+    }
+
+    if (polled[0].revents != 0) {
+      int fd = accept(m_listen_fd, nullptr, nullptr);
+
+      if (fd != -1) {
+        set_socket_options(fd, true);
+        idle.push_back(fd);
+      }
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stop = true;
+  }
+
+  pending_available.notify_all();
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  // connections open (requests being answered have been finished by the workers)
+  for (auto fd : idle) {
+    close(fd);
+  }
+
+  for (auto fd : pending) {
+    close(fd);
+  }
+
+  for (auto fd : returned) {
+    close(fd);
+  }
+
+  close(wake[0]);
+  close(wake[1]);
+}
+
+/*****************************************
+QueryClient
+******************************************/
+QueryClient::QueryClient(const std::string& path) {
+  m_fd = connect_socket(path);
+
+  if (m_fd == -1) {
+    throw std::invalid_argument("Could not connect to a server on the socket");
+  }
+
+  set_socket_options(m_fd, false);
+}
+
+QueryClient::~QueryClient() {
+  if (m_fd != -1) {
+    close(m_fd);
+  }
+}
+
+int QueryClient::request(int type, int count, const std::vector<int32_t>& queries, std::vector<int32_t>& response) {
+  int32_t header[2] = { type, count };
+
+  if (!write_all(m_fd, header, sizeof(header)) ||
+      !write_all(m_fd, queries.data(), queries.size() * sizeof(int32_t))) {
+    throw std::runtime_error("Could not send request to server");
+  }
+
+  int32_t response_header[2];
+
+  if (!read_all(m_fd, response_header, sizeof(response_header))) {
+    throw std::runtime_error("Could not receive response from server");
+  }
+
+  if (response_header[1] < 0) {
+    throw std::runtime_error("Invalid response from server");
+  }
+
+  response.resize(response_header[1]);
+
+  if (!read_all(m_fd, response.data(), response.size() * sizeof(int32_t))) {
+    throw std::runtime_error("Could not receive response from server");
+  }
+
+  return response_header[0];
+}
+
+#else
+QueryServer::QueryServer(const QueryEngine& engine, const std::string& path) :
+  m_engine(engine), m_path(path) {
+  throw std::runtime_error("The query server is not supported on Windows");
+}
+
+QueryServer::~QueryServer() {
+}
+
+int QueryServer::serve_request(int fd, std::vector<int32_t>& queries, std::vector<int32_t>& response) const {
+  return QUERY_CONNECTION_CLOSE;
+}
+
+void QueryServer::run(int threads, bool (*should_stop)(), int poll_ms) {
+}
+
+QueryClient::QueryClient(const std::string& path) {
+  throw std::runtime_error("The query server is not supported on Windows");
+}
+
+QueryClient::~QueryClient() {
+}
+
+int QueryClient::request(int type, int count, const std::vector<int32_t>& queries, std::vector<int32_t>& response) {
+  return QUERY_STATUS_BAD_REQUEST;
+}
+#endif
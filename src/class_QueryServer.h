@@ -0,0 +1,124 @@
+/**
+ class_QueryServer.h
+ Purpose: Header for C++ classes answering queries on pedigrees over a local socket.
+ Details: C++ header.
+
+ @author Mikkel Meyer Andersen
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define QUERY_INFO 1
+#define QUERY_MATCH_COUNTS 2
+#define QUERY_RELATIVES 3
+#define QUERY_DISTANCES 4
+#define QUERY_SHUTDOWN 5
+
+#define QUERY_STATUS_OK 0
+#define QUERY_STATUS_BAD_REQUEST 1
+#define QUERY_STATUS_UNKNOWN_PID 2
+#define QUERY_STATUS_RESPONSE_TOO_LARGE 3 // more than INT32_MAX words
+
+#define QUERY_CONNECTION_KEEP 0
+#define QUERY_CONNECTION_CLOSE 1
+#define QUERY_CONNECTION_SHUTDOWN 2
+
+// largest request (in int32's after the header) that is accepted
+#define QUERY_MAX_WORDS (1 << 26)
+
+/*
+QueryEngine holds a flat copy of pedigrees with haplotypes (see PedigreeIndex)
+and answers queries on them. It is built on the main thread and is afterwards
+read-only (and does not call R), so queries can be answered by worker threads.
+
+The protocol is int32's in the byte order of the machine (the socket is local).
+A request is a header (query type, count) followed by count queries:
+  QUERY_INFO:         no queries; the response is loci and the number of individuals
+                      in the generations used for match counts.
+  QUERY_MATCH_COUNTS: count haplotypes (loci int32's each); the response is the number
+                      of individuals with each haplotype.
+  QUERY_RELATIVES:    count (pid, max_L1); the response is, for each query, the number of
+                      relatives m followed by m (pid, meioses, L1) for the individuals in
+                      the same pedigree with haplotypes at most max_L1 from the pid's.
+  QUERY_DISTANCES:    count (pid_1, pid_2); the response is (meioses, L1) for each pair,
+                      where meioses is -1 if they are not in the same pedigree.
+  QUERY_SHUTDOWN:     no queries; the server stops after answering.
+A response is a header (status, words) followed by words int32's;
+a batch whose response would exceed INT32_MAX words gets QUERY_STATUS_RESPONSE_TOO_LARGE.
+
+QueryServer serves a QueryEngine on a Unix domain socket: the calling thread accepts
+connections and polls the idle ones, and each request is answered by one of a pool of
+worker threads, after which the connection is idle again. So idle connections
+(e.g. clients kept open between requests) do not hold workers.
+QueryClient is a connection to a QueryServer.
+Not supported on Windows.
+*/
+class QueryEngine {
+  private:
+    PedigreeIndex m_index;
+    size_t m_loci;
+    std::vector<int> m_haplotypes; // individual i's haplotype is at [i*loci, (i+1)*loci)
+    std::unordered_map<int, int> m_pid_index;
+    std::unordered_map< std::vector<int>, int > m_match_counts;
+    int m_match_individuals;
+
+    int index_of(int pid) const; // -1 if unknown
+    int haplotype_L1(int i, int j) const;
+
+  public:
+    QueryEngine(const std::vector<Pedigree*>& pedigrees, int generation_upper_bound_in_result);
+
+    size_t get_loci() const;
+
+    // returns the status; response is the payload
+    int answer(int type, int count, const std::vector<int32_t>& queries, std::vector<int32_t>& response) const;
+
+    // words in the queries of a request, -1 if type is unknown
+    long request_words(int type, int count) const;
+};
+
+class QueryServer {
+  private:
+    const QueryEngine& m_engine;
+    std::string m_path;
+    int m_listen_fd = -1;
+
+  public:
+    QueryServer(const QueryEngine& engine, const std::string& path);
+    ~QueryServer();
+
+    QueryServer(const QueryServer&) = delete;
+    QueryServer& operator=(const QueryServer&) = delete;
+
+    /*
+    Serve until a QUERY_SHUTDOWN request or until should_stop() is true
+    (checked from the calling thread at least every poll_ms milliseconds).
+    */
+    void run(int threads, bool (*should_stop)(), int poll_ms);
+
+    /*
+    Answer one request on a connection (that has data); returns QUERY_CONNECTION_KEEP,
+    QUERY_CONNECTION_CLOSE (closed by the client or failed) or QUERY_CONNECTION_SHUTDOWN
+    (a QUERY_SHUTDOWN request was answered).
+    */
+    int serve_request(int fd, std::vector<int32_t>& queries, std::vector<int32_t>& response) const;
+};
+
+class QueryClient {
+  private:
+    int m_fd = -1;
+
+  public:
+    QueryClient(const std::string& path);
+    ~QueryClient();
+
+    QueryClient(const QueryClient&) = delete;
+    QueryClient& operator=(const QueryClient&) = delete;
+
+    // returns the status; response is the payload
+    int request(int type, int count, const std::vector<int32_t>& queries, std::vector<int32_t>& response);
+};
@@ -0,0 +1,297 @@
+/**
+ class_RNG.cpp
+ Purpose: C++ class RNG.
+ Details: C++ implementation.
+  
+ @author Mikkel Meyer Andersen
+ */
+
+#include "malan_types.h"
+
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+#include <RcppArmadillo.h> // FIXME: Avoid Rcpp here? Only in api_* files?
+
+/*****************************************
+RNG
+******************************************/
+void RNG::unif_rand_fill(double* x, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    x[i] = this->unif_rand();
+  }
+}
+
+void RNG::gamma_rand_fill(double* x, size_t n, double shape, double scale) {
+  for (size_t i = 0; i < n; ++i) {
+    x[i] = this->gamma_rand(shape, scale);
+  }
+}
+
+// Counts the successes by jumping geometric waiting times between them:
+// exact, and uses about n*min(p, 1 - p) + 1 uniforms (no underflow for large n)
+int RNG::binom_rand(int n, double p) {
+  if (n <= 0 || p <= 0.0) {
+    return 0;
+  }
+  
+  if (p >= 1.0) {
+    return n;
+  }
+  
+  if (p > 0.5) {
+    return n - this->binom_rand(n, 1.0 - p);
+  }
+  
+  double log_q = std::log1p(-p);
+  int successes = 0;
+  double trial = 0.0; // trials used so far
+  
+  while (true) {
+    // failures before the next success
+    trial += std::floor(std::log(1.0 - this->unif_rand()) / log_q) + 1.0;
+    
+    if (trial > (double)n) {
+      return successes;
+    }
+    
+    successes += 1;
+  }
+}
+
+/*****************************************
+RRNG
+******************************************/
+double RRNG::unif_rand() {
+  return R::unif_rand();
+}
+
+void RRNG::unif_rand_fill(double* x, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    x[i] = R::unif_rand();
+  }
+}
+
+double RRNG::gamma_rand(double shape, double scale) {
+  return R::rgamma(shape, scale);
+}
+
+int RRNG::binom_rand(int n, double p) {
+  return (int)R::rbinom(n, p);
+}
+
+RNG* get_R_rng() {
+  static RRNG r_rng;
+  return &r_rng;
+}
+
+uint64_t draw_seed_from_R() {
+  // 2 x 32 bits from R's generator
+  uint64_t hi = (uint64_t)(R::unif_rand() * 4294967296.0);
+  uint64_t lo = (uint64_t)(R::unif_rand() * 4294967296.0);
+  
+  return (hi << 32) | lo;
+}
+
+
+/*****************************************
+StreamRNG
+******************************************/
+static inline uint64_t rotl(const uint64_t x, int k) {
+  return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t splitmix64(uint64_t* x) {
+  uint64_t z = ((*x) += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+// O(1) in stream: the stream number is mixed into the seed of splitmix64
+StreamRNG::StreamRNG(uint64_t seed, uint64_t stream) {
+  uint64_t ss = stream;
+  uint64_t sm = seed ^ splitmix64(&ss);
+  
+  for (int i = 0; i < 4; ++i) {
+    m_state[i] = splitmix64(&sm);
+  }
+}
+
+// xoshiro256** by David Blackman and Sebastiano Vigna (public domain)
+uint64_t StreamRNG::next() {
+  const uint64_t result = rotl(m_state[1] * 5, 7) * 9;
+  const uint64_t t = m_state[1] << 17;
+  
+  m_state[2] ^= m_state[0];
+  m_state[3] ^= m_state[1];
+  m_state[1] ^= m_state[2];
+  m_state[0] ^= m_state[3];
+  m_state[2] ^= t;
+  m_state[3] = rotl(m_state[3], 45);
+  
+  return result;
+}
+
+// Uniform on the open interval (0, 1), like R's unif_rand()
+double StreamRNG::unif_rand() {
+  return ((double)(this->next() >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+void StreamRNG::unif_rand_fill(double* x, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    x[i] = ((double)(this->next() >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+  }
+}
+
+// Marsaglia polar method
+double StreamRNG::norm_rand() {
+  if (m_normal_spare_set) {
+    m_normal_spare_set = false;
+    return m_normal_spare;
+  }
+  
+  double u, v, s;
+  
+  do {
+    u = 2.0*this->unif_rand() - 1.0;
+    v = 2.0*this->unif_rand() - 1.0;
+    s = u*u + v*v;
+  } while (s >= 1.0 || s == 0.0);
+  
+  s = std::sqrt(-2.0*std::log(s) / s);
+  
+  m_normal_spare = v*s;
+  m_normal_spare_set = true;
+  
+  return u*s;
+}
+
+// Marsaglia and Tsang (2000), A Simple Method for Generating Gamma Variables
+// (shape >= 1; d and c depend only on shape)
+static inline double marsaglia_tsang(StreamRNG* rng, double d, double c) {
+  while (true) {
+    double x, v;
+    
+    do {
+      x = rng->norm_rand();
+      v = 1.0 + c*x;
+    } while (v <= 0.0);
+    
+    v = v*v*v;
+    double u = rng->unif_rand();
+    double x2 = x*x;
+    
+    if (u < 1.0 - 0.0331*x2*x2) {
+      return d*v;
+    }
+    
+    if (std::log(u) < 0.5*x2 + d*(1.0 - v + std::log(v))) {
+      return d*v;
+    }
+  }
+}
+
+double StreamRNG::gamma_rand(double shape, double scale) {
+  if (shape < 1.0) {
+    // boost: Gamma(a) = Gamma(a + 1) * U^(1/a)
+    double u = this->unif_rand();
+    return this->gamma_rand(1.0 + shape, scale) * std::pow(u, 1.0 / shape);
+  }
+  
+  const double d = shape - 1.0/3.0;
+  const double c = 1.0 / std::sqrt(9.0*d);
+  
+  return marsaglia_tsang(this, d, c)*scale;
+}
+
+// Same stream as gamma_rand() n times, with the constants computed once
+void StreamRNG::gamma_rand_fill(double* x, size_t n, double shape, double scale) {
+  bool boost = (shape < 1.0);
+  double shape_1 = (boost) ? 1.0 + shape : shape;
+  
+  const double d = shape_1 - 1.0/3.0;
+  const double c = 1.0 / std::sqrt(9.0*d);
+  
+  for (size_t i = 0; i < n; ++i) {
+    if (boost) {
+      double u = this->unif_rand();
+      x[i] = marsaglia_tsang(this, d, c)*scale * std::pow(u, 1.0 / shape);
+    } else {
+      x[i] = marsaglia_tsang(this, d, c)*scale;
+    }
+  }
+}
+
+
+/*****************************************
+BufferedRNG
+******************************************/
+static bool rng_compatible = true;
+
+bool get_rng_compatible() {
+  return rng_compatible;
+}
+
+void set_rng_compatible(bool compatible) {
+  rng_compatible = compatible;
+}
+
+BufferedRNG::BufferedRNG(RNG* source, bool exact, size_t chunk_size) {
+  m_source = source;
+  m_exact = exact;
+  m_chunk_size = (chunk_size > 0) ? chunk_size : 1;
+}
+
+// Append n uniforms from source (after the ones not yet used)
+void BufferedRNG::fill(size_t n) {
+  size_t left = m_buffer.size() - m_next;
+  
+  if (m_next > 0) {
+    std::copy(m_buffer.begin() + m_next, m_buffer.end(), m_buffer.begin());
+    m_next = 0;
+  }
+  
+  m_buffer.resize(left + n);
+  m_source->unif_rand_fill(&(m_buffer[left]), n);
+}
+
+void BufferedRNG::reserve(size_t n) {
+  size_t left = m_buffer.size() - m_next;
+  
+  if (left >= n) {
+    return;
+  }
+  
+  if (m_exact) {
+    this->fill(n - left);
+  } else {
+    this->fill(std::max(n - left, m_chunk_size));
+  }
+}
+
+double BufferedRNG::gamma_rand(double shape, double scale) {
+  // the source draws its own uniforms, so in exact mode the buffer must be used up
+  if (m_exact && m_next != m_buffer.size()) {
+    throw std::logic_error("BufferedRNG: reserved uniforms not used before gamma_rand()");
+  }
+  
+  return m_source->gamma_rand(shape, scale);
+}
+
+int BufferedRNG::binom_rand(int n, double p) {
+  if (m_exact && m_next != m_buffer.size()) {
+    throw std::logic_error("BufferedRNG: reserved uniforms not used before binom_rand()");
+  }
+  
+  return m_source->binom_rand(n, p);
+}
+
+void BufferedRNG::gamma_rand_fill(double* x, size_t n, double shape, double scale) {
+  if (m_exact && m_next != m_buffer.size()) {
+    throw std::logic_error("BufferedRNG: reserved uniforms not used before gamma_rand_fill()");
+  }
+  
+  m_source->gamma_rand_fill(x, n, shape, scale);
+}
@@ -0,0 +1,113 @@
+/**
+ class_RNG.h
+ Purpose: Header for C++ class RNG.
+ Details: C++ header.
+  
+ @author Mikkel Meyer Andersen
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+RNG is the source of randomness for the simulation classes.
+
+RRNG uses R's random number generator (and thereby honours set.seed()), 
+but must only be used from the main thread.
+
+StreamRNG is a self-contained xoshiro256** generator that does not touch R at all 
+and can hence be used from worker threads. Streams with the same seed but different 
+stream numbers are seeded independently (by splitmix64 of seed and stream number) in O(1), 
+so a generator per task (e.g. per replicate or block) is cheap; with a period of 2^256 - 1, 
+overlaps between streams are practically impossible.
+
+BufferedRNG draws uniforms from another RNG in bulk (into a buffer) and hands 
+them out one by one. In exact (R compatible) mode, it only draws uniforms 
+that are known to be used (announced by reserve()), so the stream of uniforms 
+drawn from the source (e.g. R's generator after set.seed()) is exactly the same 
+as without buffering. Else it draws chunks, and unused uniforms are discarded 
+when the BufferedRNG is destroyed.
+*/
+class RNG {
+  public:
+    virtual ~RNG() {}
+    virtual double unif_rand() = 0;
+    virtual double gamma_rand(double shape, double scale) = 0;
+    
+    // x[0], ..., x[n-1] = unif_rand()
+    virtual void unif_rand_fill(double* x, size_t n);
+    
+    // x[0], ..., x[n-1] = gamma_rand(shape, scale)
+    virtual void gamma_rand_fill(double* x, size_t n, double shape, double scale);
+    
+    // Binomial(n, p) variate
+    virtual int binom_rand(int n, double p);
+    
+    // Hint that at least n uniforms will be drawn by unif_rand() 
+    // before any other use of the generator
+    virtual void reserve(size_t /* n */) {}
+};
+
+class RRNG: public RNG {
+  public:
+    double unif_rand();
+    void unif_rand_fill(double* x, size_t n);
+    double gamma_rand(double shape, double scale);
+    int binom_rand(int n, double p);
+};
+
+class StreamRNG: public RNG {
+  private:
+    uint64_t m_state[4];
+    
+    bool m_normal_spare_set = false;
+    double m_normal_spare = 0.0;
+    
+  public:
+    StreamRNG(uint64_t seed, uint64_t stream);
+    uint64_t next();
+    double unif_rand();
+    void unif_rand_fill(double* x, size_t n);
+    double norm_rand();
+    double gamma_rand(double shape, double scale);
+    void gamma_rand_fill(double* x, size_t n, double shape, double scale);
+};
+
+// R's random number generator, shared instance
+RNG* get_R_rng();
+
+// Whether BufferedRNG's are exact (R compatible) by default
+bool get_rng_compatible();
+void set_rng_compatible(bool compatible);
+
+class BufferedRNG: public RNG {
+  private:
+    RNG* m_source;
+    bool m_exact;
+    size_t m_chunk_size;
+    
+    std::vector<double> m_buffer;
+    size_t m_next = 0;
+    
+    void fill(size_t n);
+    
+  public:
+    BufferedRNG(RNG* source = get_R_rng(), bool exact = get_rng_compatible(), size_t chunk_size = 4096);
+    
+    double unif_rand() {
+      if (m_next == m_buffer.size()) {
+        this->fill(m_exact ? 1 : m_chunk_size);
+      }
+      
+      return m_buffer[m_next++];
+    }
+    
+    double gamma_rand(double shape, double scale);
+    void gamma_rand_fill(double* x, size_t n, double shape, double scale);
+    int binom_rand(int n, double p);
+    void reserve(size_t n);
+};
+
+// Draw a seed from R's random number generator (so that set.seed() governs it)
+uint64_t draw_seed_from_R();
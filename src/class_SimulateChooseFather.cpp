@@ -10,12 +10,15 @@
 
 #include <RcppArmadillo.h> // FIXME: Avoid Rcpp here? Only in api_* files?
 
+#include <algorithm>
+
 
 /*****************************************
 WFRandomFather
 ******************************************/
-WFRandomFather::WFRandomFather(size_t population_size) {
+WFRandomFather::WFRandomFather(size_t population_size, RNG* rng) {
   m_population_size = (double)population_size;
+  m_rng = rng;
 }
 
 void WFRandomFather::update_state_new_generation() {  
@@ -24,17 +27,26 @@ void WFRandomFather::update_state_new_generation() {
 
 int WFRandomFather::get_father_i() {
   //Rcpp::Rcout << "WFRandomFather: get_father_i" << std::endl;
-  return R::runif(0, 1)*m_population_size;
+  return m_rng->unif_rand()*m_population_size;
+}
+
+void WFRandomFather::set_population_size(size_t population_size) {
+  m_population_size = (double)population_size;
 }
 
 
 /*****************************************
 GammaVarianceRandomFather
 ******************************************/
-GammaVarianceRandomFather::GammaVarianceRandomFather(size_t population_size, double gamma_parameter_shape, double gamma_parameter_scale) {
+GammaVarianceRandomFather::GammaVarianceRandomFather(size_t population_size, double gamma_parameter_shape, double gamma_parameter_scale, RNG* rng) {
   m_population_size = population_size;
   m_gamma_parameter_shape = gamma_parameter_shape;
   m_gamma_parameter_scale = gamma_parameter_scale;
+  m_rng = rng;
+}
+
+void GammaVarianceRandomFather::set_population_size(size_t population_size) {
+  m_population_size = population_size;
 }
 
 // modified from 
@@ -43,35 +55,50 @@ GammaVarianceRandomFather::GammaVarianceRandomFather(size_t population_size, dou
 void GammaVarianceRandomFather::update_state_new_generation() {    
   //Rcpp::Rcout << "GammaVarianceRandomFather: update_state_new_generation" << std::endl;
   
-  Rcpp::NumericVector fathers_prob_tmpl = Rcpp::rgamma(m_population_size, m_gamma_parameter_shape, m_gamma_parameter_scale);
-  //Rcpp::Rcout << "mean[fathers_prob_tmpl] = " << Rcpp::mean(fathers_prob_tmpl) << ", var[fathers_prob_tmpl] = " << Rcpp::var(fathers_prob_tmpl) << std::endl;
-  fathers_prob_tmpl = fathers_prob_tmpl / sum(fathers_prob_tmpl);    
-
-  arma::vec fathers_prob(fathers_prob_tmpl.begin(), fathers_prob_tmpl.size(), false); // false means no copy
-  arma::uvec fathers_prob_perm = arma::sort_index(fathers_prob, "descend"); //descending sort of index
-  fathers_prob = arma::sort(fathers_prob, "descend");  // descending sort of prob
-  fathers_prob = arma::cumsum(fathers_prob);
+  // No R objects here: must be usable from worker threads with a StreamRNG.
+  // With R's RNG, this is the same stream as Rcpp::rgamma(m_population_size, ...).
+  m_fathers_prob.resize(m_population_size);
+  m_fathers_prob_cum.resize(m_population_size);
+  m_fathers_prob_perm.resize(m_population_size);
+  
+  double* fathers_prob = m_fathers_prob.data();
+  m_rng->gamma_rand_fill(fathers_prob, m_population_size, m_gamma_parameter_shape, m_gamma_parameter_scale);
+  
+  double fathers_prob_sum = 0.0;
+  
+  for (size_t i = 0; i < m_population_size; ++i) {
+    fathers_prob_sum += fathers_prob[i];
+  }
+  
+  for (size_t i = 0; i < m_population_size; ++i) {
+    fathers_prob[i] = fathers_prob[i] / fathers_prob_sum;
+  }
+  
+  // descending sort of index (ties by index, as arma::sort_index)
+  for (size_t i = 0; i < m_population_size; ++i) {
+    m_fathers_prob_perm[i] = i;
+  }
+  
+  std::stable_sort(m_fathers_prob_perm.begin(), m_fathers_prob_perm.end(), 
+    [fathers_prob](size_t a, size_t b) { return fathers_prob[a] > fathers_prob[b]; });
   
-  m_fathers_prob_cum = fathers_prob;
-  m_fathers_prob_perm = fathers_prob_perm;
+  double cum = 0.0;
+  
+  for (size_t i = 0; i < m_population_size; ++i) {
+    cum += fathers_prob[m_fathers_prob_perm[i]];
+    m_fathers_prob_cum[i] = cum;
+  }
 }
 
 int GammaVarianceRandomFather::get_father_i() {
   //Rcpp::Rcout << "GammaVarianceRandomFather: get_father_i" << std::endl;
   
-  double rU = R::unif_rand(); // R's internal random number generation
-  //double rU = R::runif(0, 1);
+  double rU = m_rng->unif_rand();
 
-  int jj;
-  size_t population_size_1 = m_population_size - 1;
-  
-  for (jj = 0; jj < population_size_1; ++jj) {
-    if (rU <= m_fathers_prob_cum[jj]) {
-      break;
-    }
-  }
+  // first jj with rU <= cum[jj], else the last man (guards against rounding in cum)
+  auto last = m_fathers_prob_cum.begin() + (m_population_size - 1);
+  size_t jj = std::lower_bound(m_fathers_prob_cum.begin(), last, rU) - m_fathers_prob_cum.begin();
   
   return m_fathers_prob_perm[jj];
 }
 
-
@@ -8,20 +8,31 @@
 
 #include <RcppArmadillo.h> // FIXME: Avoid Rcpp here? Only in api_* files?
 
+#include <vector>
+
 class SimulateChooseFather {
   public:
     virtual void update_state_new_generation() = 0;
     virtual int get_father_i() = 0;
+    
+    // For varying population sizes: takes effect from the next update_state_new_generation()
+    virtual void set_population_size(size_t population_size) = 0;
+    
+    // Is each man equally likely to be the father (standard Wright-Fisher)?
+    virtual bool is_uniform() { return false; }
 };
 
 class WFRandomFather: public SimulateChooseFather {
   private:
     double m_population_size;
+    RNG* m_rng;
     
   public:
-    WFRandomFather(size_t population_size);
+    WFRandomFather(size_t population_size, RNG* rng = get_R_rng());
     void update_state_new_generation();
     int get_father_i();
+    void set_population_size(size_t population_size);
+    bool is_uniform() { return true; }
 };
 
 
@@ -31,13 +42,16 @@ class GammaVarianceRandomFather: public SimulateChooseFather {
     size_t m_population_size;
     double m_gamma_parameter_shape;
     double m_gamma_parameter_scale;
+    RNG* m_rng;
     
-    // new for each generation
-    arma::vec m_fathers_prob_cum;
-    arma::uvec m_fathers_prob_perm;
+    // new for each generation (buffers are reused, only reallocated if the population grows)
+    std::vector<double> m_fathers_prob;
+    std::vector<double> m_fathers_prob_cum;
+    std::vector<size_t> m_fathers_prob_perm;
     
   public:
-    GammaVarianceRandomFather(size_t population_size, double gamma_parameter_shape, double gamma_parameter_scale);
+    GammaVarianceRandomFather(size_t population_size, double gamma_parameter_shape, double gamma_parameter_scale, RNG* rng = get_R_rng());
     void update_state_new_generation();
     int get_father_i();
+    void set_population_size(size_t population_size);
  };
@@ -0,0 +1,163 @@
+/**
+ class_SubtreeStatistics.cpp
+ Purpose: C++ class SubtreeStatistics.
+ Details: C++ implementation.
+  
+ @author Mikkel Meyer Andersen
+ */
+
+#include "malan_types.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_set>
+
+SubtreeStatistics::SubtreeStatistics(const PedigreeIndex& index, int generation_max, bool haplotypes) {
+  if (generation_max < 0) {
+    throw std::invalid_argument("generation_max must be >= 0");
+  }
+  
+  m_generation_max = generation_max;
+  m_haplotypes = haplotypes;
+  
+  size_t n = index.size();
+  
+  m_pid.resize(n);
+  m_generation.resize(n);
+  m_descendants.assign(n, 0);
+  m_descendants_generation.assign(n * (generation_max + 1), 0);
+  m_depth.assign(n, 0);
+  m_distinct_haplotypes.assign(n, 0);
+  
+  for (size_t i = 0; i < n; ++i) {
+    Individual* individual = index.get_individual(i);
+    
+    if (haplotypes && !(individual->is_haplotype_set())) {
+      throw std::invalid_argument("Haplotypes not set, did you populate haplotypes?");
+    }
+    
+    m_pid[i] = individual->get_pid();
+    m_generation[i] = individual->get_generation();
+    m_pid_index[m_pid[i]] = i;
+  }
+}
+
+void SubtreeStatistics::compute_pedigree(const PedigreeIndex& index, int p) {
+  int begin = index.get_pedigree_begin(p);
+  int end = index.get_pedigree_end(p);
+  size_t buckets = m_generation_max + 1;
+  
+  // haplotypes numbered within the pedigree, and the sets of these in the subtrees 
+  // (a son's set is merged into his father's, smaller into larger)
+  std::unordered_map<std::vector<int>, int> haplotype_id;
+  std::vector< std::unordered_set<int>* > subtree_haplotypes;
+  
+  if (m_haplotypes) {
+    subtree_haplotypes.assign(end - begin, nullptr);
+  }
+  
+  // sons have larger indices than their fathers
+  for (int i = end - 1; i >= begin; --i) {
+    int father = index.get_father(i);
+    int generation = m_generation[i];
+    bool in_buckets = (generation <= m_generation_max);
+    
+    if (m_haplotypes) {
+      std::unordered_set<int>*& haps = subtree_haplotypes[i - begin];
+      
+      if (haps == nullptr) {
+        haps = new std::unordered_set<int>();
+      }
+      
+      if (in_buckets) {
+        auto got = haplotype_id.insert(std::make_pair(index.get_individual(i)->get_haplotype(), (int)haplotype_id.size()));
+        haps->insert(got.first->second);
+      }
+      
+      m_distinct_haplotypes[i] = haps->size();
+      
+      if (father != -1) {
+        std::unordered_set<int>*& father_haps = subtree_haplotypes[father - begin];
+        
+        if (father_haps == nullptr) {
+          father_haps = haps;
+        } else {
+          if (father_haps->size() < haps->size()) {
+            std::swap(father_haps, haps);
+          }
+          
+          father_haps->insert(haps->begin(), haps->end());
+          delete haps;
+        }
+      } else {
+        delete haps;
+      }
+      
+      haps = nullptr;
+    }
+    
+    if (father == -1) {
+      continue;
+    }
+    
+    m_descendants[father] += m_descendants[i] + 1;
+    m_depth[father] = std::max(m_depth[father], m_depth[i] + 1);
+    
+    int* counts = &(m_descendants_generation[i * buckets]);
+    int* father_counts = &(m_descendants_generation[father * buckets]);
+    
+    for (size_t g = 0; g < buckets; ++g) {
+      father_counts[g] += counts[g];
+    }
+    
+    if (in_buckets) {
+      father_counts[generation] += 1;
+    }
+  }
+}
+
+int SubtreeStatistics::size() const {
+  return m_pid.size();
+}
+
+int SubtreeStatistics::get_generation_max() const {
+  return m_generation_max;
+}
+
+bool SubtreeStatistics::has_haplotypes() const {
+  return m_haplotypes;
+}
+
+int SubtreeStatistics::get_index(int pid) const {
+  auto got = m_pid_index.find(pid);
+  
+  if (got == m_pid_index.end()) {
+    return -1;
+  }
+  
+  return got->second;
+}
+
+int SubtreeStatistics::get_pid(int i) const {
+  return m_pid[i];
+}
+
+int SubtreeStatistics::get_generation(int i) const {
+  return m_generation[i];
+}
+
+int SubtreeStatistics::get_descendants(int i) const {
+  return m_descendants[i];
+}
+
+int SubtreeStatistics::get_descendants_generation(int i, int generation) const {
+  return m_descendants_generation[i * (m_generation_max + 1) + generation];
+}
+
+int SubtreeStatistics::get_depth(int i) const {
+  return m_depth[i];
+}
+
+int SubtreeStatistics::get_distinct_haplotypes(int i) const {
+  return m_distinct_haplotypes[i];
+}
@@ -0,0 +1,54 @@
+/**
+ class_SubtreeStatistics.h
+ Purpose: Header for C++ class SubtreeStatistics.
+ Details: C++ header.
+  
+ @author Mikkel Meyer Andersen
+ */
+
+#include "malan_types.h"
+
+#include <unordered_map>
+#include <vector>
+
+/*
+SubtreeStatistics holds, for each individual in a PedigreeIndex, statistics about 
+his descendants (his subtree): the number of descendants in total and in each of 
+generations 0, 1, ..., generation_max, the depth (number of generations to his 
+youngest descendant) and, optionally, the number of distinct haplotypes amongst 
+himself and his descendants in generations 0, 1, ..., generation_max.
+
+The statistics of a pedigree are computed by compute_pedigree() in one bottom-up pass 
+(sons before fathers, i.e. by decreasing index); different pedigrees can be 
+computed in parallel as they write to disjoint parts.
+*/
+class SubtreeStatistics {
+private:
+  int m_generation_max;
+  bool m_haplotypes;
+  
+  std::vector<int> m_pid;
+  std::vector<int> m_generation;
+  std::vector<int> m_descendants;
+  std::vector<int> m_descendants_generation; // individual i's in [i*(generation_max + 1), (i+1)*(generation_max + 1))
+  std::vector<int> m_depth;
+  std::vector<int> m_distinct_haplotypes;
+  
+  std::unordered_map<int, int> m_pid_index;
+  
+public:
+  SubtreeStatistics(const PedigreeIndex& index, int generation_max, bool haplotypes);
+  
+  void compute_pedigree(const PedigreeIndex& index, int p);
+  
+  int size() const;
+  int get_generation_max() const;
+  bool has_haplotypes() const;
+  int get_index(int pid) const; // -1 if not found
+  int get_pid(int i) const;
+  int get_generation(int i) const;
+  int get_descendants(int i) const;
+  int get_descendants_generation(int i, int generation) const;
+  int get_depth(int i) const;
+  int get_distinct_haplotypes(int i) const;
+};
@@ -22,8 +22,7 @@ bool find_path_from_root_to_dest(Individual* root, std::vector<Individual*>& pat
     return true;
   }
 
-  std::vector<Individual*>* children = root->get_children();
-  for (auto child : *children) {
+  for (auto child : root->get_children()) {
     if (find_path_from_root_to_dest(child, path, dest)) {
       return true;
     }
@@ -42,13 +41,14 @@ bool find_path_from_root_to_dest(Individual* root, std::vector<Individual*>& pat
 // @return Vector of length 2 with indices of alleles
 std::vector<int> draw_autosomal_genotype(
     const std::vector<double>& allele_cumdist_theta,
-    const int alleles_count) {
+    const int alleles_count,
+    RNG* rng) {
   
   std::vector<int> geno(2);
   geno[0] = -1;
   geno[1] = -1;
 
-  double u = R::runif(0.0, 1.0);
+  double u = rng->unif_rand();
   bool stop = false;
 
   int k = 0;
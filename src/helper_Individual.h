@@ -17,6 +17,7 @@ bool find_path_from_root_to_dest(Individual* root, std::vector<Individual*>& pat
 
 std::vector<int> draw_autosomal_genotype(
     const std::vector<double>& allele_cumdist_theta,
-    const int alleles_count);
+    const int alleles_count,
+    RNG* rng = get_R_rng());
   
 #endif
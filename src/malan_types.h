@@ -37,11 +37,19 @@ class Population;
 //class WFRandomFather;
 //class GammaVarianceRandomFather;
 
+#include "class_RNG.h"
+
 #include "helper_Individual.h"
 
 #include "class_Individual.h"
 #include "class_Pedigree.h"
 #include "class_Population.h"
+#include "class_PedigreeIndex.h"
+#include "class_SubtreeStatistics.h"
 #include "class_SimulateChooseFather.h"
+#include "class_GenerationSink.h"
+#include "class_GenerationFile.h"
+#include "class_QueryServer.h"
+#include "class_PopulationSnapshot.h"
 
 #endif